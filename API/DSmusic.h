@@ -1,9 +1,14 @@
 #pragma once
+#include <array>
+#include <cstdint>
+#include <iosfwd>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <stdexcept>
 #include <memory>
+#include <span>
 
 namespace DS {
 // Զ쳣
@@ -12,6 +17,124 @@ public:
 explicit DsParserError(const std::string& msg): std::runtime_error(msg) {}
 };
 
+// ȫַűеı
+// ͬͬţֱӱȽϣֻڱЧҪдļ
+// ű̹áֻ 65536 ƣԵĶ󻹻Ϊõÿ
+// Ǽһǰ׺ƣ "zh/a"ʱв϶ƵĽӦһ
+enum class symbol : uint16_t {};
+
+// ȡƶӦıţ״γʱǼǣɶ̵߳
+// űʱǼ׳ DsParserErrorءset ϵеҪǼƵĲͬ׳
+// ʱѵǼǵճãset ϵв޸Ķload() δ״̬
+symbol intern_symbol(std::string_view name);
+// ŶӦ
+std::string_view symbol_name(symbol id);
+
+// ʱߣԴвʱ䣨*_timestep
+enum class curve_type : uint8_t {
+	f0,
+	energy,
+	breathiness,
+	voicing,
+	tension,
+	mouth_opening,
+	count
+};
+constexpr size_t curve_count = static_cast<size_t>(curve_type::count);
+
+// زĲֵʽ
+enum class interp_mode : uint8_t {
+	nearest,	// ȡĲ
+	linear,		// Բֵ
+	cubic,		// βֵFritsch-Carlson֮䲻ᳬǵķΧ
+};
+
+// ʱ֮Ŀ϶ߵ䷽ʽ
+enum class gap_fill : uint8_t {
+	hold,		// ǰһεһ֡
+	linear,		// ǰһεһ֡Թɵһεĵһ֡
+	constant,	//  pack_options::fill_value
+};
+
+// ѡ music::pack
+struct pack_options {
+	gap_fill fill = gap_fill::hold;
+	float fill_value = 0.0f;						// gap_fill::constant ʱֵf0 Ϊ 0 
+	interp_mode mode = interp_mode::linear;			// вʱ䲻ͬʱ㵽ϲĲʱõĲֵ
+};
+
+// ι滮Ĵģͣƺϲһе
+//  = frame_weight * ֡ + phoneme_weight *  + attention_weight * ֡^2֡ = ʱ / step
+// Ĭֻ֡attention_weight ڹע泤ƽĲ
+struct pack_cost {
+	float step = 512.0f / 44100.0f;	// ֡룩ĬΪ 44.1 kHz hop 512
+	double frame_weight = 1.0;
+	double phoneme_weight = 0.0;
+	double attention_weight = 0.0;
+};
+
+// еһ飺ԭʼ [first, first + count) ϲΪһ
+struct pack_group {
+	size_t first = 0;
+	size_t count = 0;
+	float offset = 0.0f;	// ϲһеƫƣеƫ
+	double seconds = 0.0;	// ϲʱмֹ
+	size_t phonemes = 0;	// ϲм SP
+	double cost = 0.0;		// ģ͹
+};
+
+// ԭʼںϲһеλ
+struct pack_row {
+	size_t group = 0;		// ڵ飬ϲĵڼ
+	double start = 0.0;		// ںϲһеʼʱ䣨룩
+	double seconds = 0.0;	// еʱ
+
+	//  step Ϊ֡ʱռݵ֡ [first_frame, end_frame) pack ƴʱλһ
+	// ֮䲻κһе֡ǲֹ
+	size_t first_frame(float step) const;
+	size_t end_frame(float step) const;
+};
+
+//  music::planPack˳򸲸ȫ
+// ϲĸһʱҪ䵽һУpadding ɴ˷ѵı
+struct pack_plan {
+	std::vector<pack_group> groups;
+	std::vector<pack_row> rows;		// ԭʼ
+	double cost = 0.0;		// ֮
+	double padded = 0.0;	//  * һĴ
+	double padding = 0.0;	// 1 - cost / paddedԽСԽ
+};
+
+// зֺһԭʼ row  [start, start + seconds) Ĳ֣ʱߣ룩
+struct split_piece {
+	size_t row = 0;
+	double start = 0.0;
+	double seconds = 0.0;
+
+	//  step Ϊ֡ʱһԭʼռݵ֡ [first_frame, end_frame)зʱλһ
+	size_t first_frame(float step) const;
+	size_t end_frame(float step) const;
+};
+
+// зֵĽ music::splitLongRowspieces зֺ
+struct split_plan {
+	std::vector<split_piece> pieces;
+	size_t rows = 0;		// зǰ
+};
+
+// DS ıѡ music::write
+struct write_options {
+	// УʱߣСλʡĩβ 0С 0 ʱɾȷص̱ʾ
+	// ƫʱʼհ̱ʾ
+	int precision = -1;
+};
+
+// ͳ
+struct cache_stats {
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+};
+
 //>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 // DS  DS::music
 // ִ֧ڴмݻֱӽ DS 
@@ -30,27 +153,82 @@ public:
 	virtual ~music() = default;
 
 	// ʼҪֶβ洢ڳԱ
-	// ̼߳أⲿ
+	// ڲ߳ͬʱʱֻһ
 	virtual	void load() = 0;
 
+	// гʼлָ parallelism ߳ͬʱ
+	// 0 ʾʹӲ߳ȫнɺŽѼ״̬
+	virtual void load(unsigned parallelism) = 0;
+
 	// δ GPU 
 	// ע⣺ܵ΢λ
 	// - δС()
 	// - См()
+	// ߰ںϲλ֡ƴӣʱȡϲСģм϶ options 
 	virtual void pack(
 		float time_s, 
-		float maxInterval_s
+		float maxInterval_s,
+		const pack_options& options = {}
 	) = 0;
 
 	// ƴһ
 	virtual std::vector<std::string> pack(
 		float time_s,
 		float maxInterval_s,
-		const std::vector<std::string>& word_seq
+		const std::vector<std::string>& word_seq,
+		const pack_options& options = {}
+	) = 0;
+
+	// 滮޸ݣֻ۹ƣɽ pack(plan)packed(plan) ִУҲڱȽϲͬ
+	// ͬʱ¼ÿԭʼںϲλãpack_plan::rows scatter д
+	//  pack(time_s, maxInterval_s) ̰ͬķҺϲֱ time_s м೬ maxInterval_s
+	virtual pack_plan planPack(float time_s, float maxInterval_s, const pack_cost& cost = {}) const = 0;
+	// ⷽÿ۲ budgetһгʱԳһ飩м಻ maxInterval_s
+	//  budget ѡʹ  * ÿ СޣԶ̬滮١
+	// ֮ƽС֣鳤˾һ£˷ѣpaddedС̰ķ
+	// budget <= 0 ʱ׳ DsParserError
+	virtual pack_plan planPackBalanced(double budget, float maxInterval_s, const pack_cost& cost = {}) const = 0;
+
+	// 밴˳ز©ظȫУ׳ DsParserError
+	virtual void pack(
+		const pack_plan& plan,
+		const pack_options& options = {}
+	) = 0;
+	virtual std::vector<std::string> pack(
+		const pack_plan& plan,
+		const std::vector<std::string>& word_seq,
+		const pack_options& options = {}
+	) = 0;
+
+	// ޸ı󣬰ɴ¶Ѽ״̬Ա pack(plan) Ľͬ
+	// ɺ scatter ѽͬһдرĸ
+	virtual std::unique_ptr<music> packed(const pack_plan& plan, const pack_options& options = {}) const = 0;
+
+	// Ѵе֡ѧģ f0лԭʼ
+	// outputs[g] Ϊϲ g еĽ֡Ϊ stepԭʼ r ȡ plan.rows[r] ռ֡
+	// Ϊ type д룬ʱΪ step֡һ֡ĳûнʱ޸е
+	// 뱾вʱ׳ DsParserError
+	virtual void scatter(
+		const pack_plan& plan,
+		curve_type type,
+		const std::vector<std::vector<float>>& outputs,
+		float step
 	) = 0;
 
+	// вɸֻһеĶȰȫпһֻݸϵͼüп
+	// δ޸ϴβʹʱǷݸٿ
+	// дʱƣĳһб޸ʱŸƳԼһУӰ뱾֮޸ıҲӰѲ
+	// δ޸ĵĸпڶ߳ͬʱȡǹ
 	virtual std::vector<std::unique_ptr<music>> split() = 0;
 
+	// ʱ max_s гɼУÿξӽֺĳҲ max_s
+	// еȡֹrestеͣأSPAPһΪǰΣ
+	// ûͣʱȡر߽غϡҺһλáprefer_breaks Ϊ false ʱеͬȶԴ
+	// Ҳеʱöαԭзֺ ph_num ε»֣offset Ƶε㣬
+	// ߰ԵĲʱ֡пδзֵбԭзֵвδֶ֪
+	// ÿеԴ stitch_rows ѸεƴԭʼУmax_s <= 0 ʱ׳ DsParserError
+	virtual split_plan splitLongRows(float max_s, bool prefer_breaks = true) = 0;
+
 	// ڴм
 	// ؼǷȫȷı־
 	// ĳֶδ뵫ͨԶ޸ʱfalse
@@ -97,8 +275,19 @@ public:
 	) = 0;
 
 	// л
+	// get()write()getBinary() ڶ߳ͬʱã״лʱ JSON DOMд޸ֻһΣڲ
+	// ޸ݵķͬʱԲȫ
 	virtual std::string get()const = 0;
 
+	//  DS ı׷ӵ outδʱȼأprecision < 0 ʱ get() ͬ
+	//  JSON DOM domlazy ʽأù get() precision < 0 ʱ DOM ԭĵֶ˳ֵд
+	// ֱɸɣ JSON DOM get() öֶࣺΰ̶˳δֶ֪αÿпͷʱд
+	virtual void write(std::string& out, const write_options& options = {}) const = 0;
+	virtual void write(std::ostream& out, const write_options& options = {}) const = 0;
+
+	// лΪ DS ds_to_binary
+	virtual std::string getBinary() const = 0;
+
 	// ǷΪ
 	virtual bool empty() const = 0;
 
@@ -111,15 +300,22 @@ public:
 	// ȡԭʼ
 	virtual std::vector<std::string> getPhSeq_raw(int row) const = 0;
 
+	// ȡеķűţ getPhSeq_raw һһӦ
+	virtual const std::vector<symbol>& getPhIds(int row) const = 0;
+
 	// ȡÿڵ
 	virtual std::vector<int> getPhNum(int row) const = 0;
 
 	// ȡ
 	virtual std::vector<std::string> getNoteSeq(int row) const = 0;
 
+	// ȡеķűţ getNoteSeq һһӦ
+	virtual const std::vector<symbol>& getNoteIds(int row) const = 0;
+
 	// ȡʱ
 	virtual std::vector<float> getNoteTime(int row) const = 0;
-	virtual std::vector<float> getNoteDur(int row, float step) const = 0;
+	// ֡Ϊλʱᱻ棻ص޸ĸл clearCache() ʧЧ getCacheStats
+	virtual const std::vector<float>& getNoteDur(int row, float step) const = 0;
 
 	// ȡ־
 	virtual std::vector<int> getNoteSlur(int row) const = 0;
@@ -140,10 +336,18 @@ public:
 	virtual music& setPitch(std::vector<float> data, float offset, int row) = 0;
 	// ȡ
 	virtual const std::vector<float> getPitch(int row) const = 0; // ֱӻȡԭʼƵУû򷵻ؿ
-	virtual const std::vector<float> getPitchStep(int row, float step) const = 0; // ûԭʼУزָ
+	virtual const std::vector<float>& getPitchStep(int row, float step) const = 0; // ԭʼƵزָûԭʼУزָУػã޸ĸкʧЧ getCacheStats
 	virtual const std::vector<float> getMidi(int row) const = 0; // ȡ MIDI 
-	virtual const std::vector<float> getMidiPh(int row) const = 0; // ȡԵǰػֵ MIDI 
-	virtual const std::vector<float> getMidiStep(int row, float step) const = 0; // ָزߵ MIDI 
+	virtual const std::vector<float>& getMidiPh(int row) const = 0; // ȡԵǰػֵ MIDI Уػã޸ĸкʧЧ getCacheStats
+	virtual const std::vector<float>& getMidiStep(int row, float step) const = 0; // ָزߵ MIDI Уػã޸ĸкʧЧ getCacheStats
+	// getPitchStepgetMidiPhgetMidiStep  getNoteDur(row, step) Ľ (, ) 棬ظòټ
+	// صָ򻺴еУʧЧ
+	// - ޸ĸݣset ϵСpack clearCache()
+	// - ͬһͬһ 4 ÿÿֻ 4 ֲı
+	// Ҫڱ߳̿ͬһеʱӦȿ
+	virtual cache_stats getCacheStats() const = 0;
+	// ͷȫ
+	virtual void clearCache() = 0;
 
 	// ʱ
 	virtual music& setPhTime(std::vector<float> data, float offset, int row) = 0;
@@ -175,16 +379,133 @@ public:
 	// ȡ
 	virtual const std::vector<float>& getMouthOpening(int row) const = 0;
 
+	// ֻͼֱָڲ洢Ҳڴ
+	// ͼ޸ݣset ϵСpack֮ǰЧģʽ״ηʻȽֶ
+	virtual std::span<const symbol> viewPhSeq(int row) const = 0;	// ǰ׺ langSymbol 
+	virtual std::span<const int> viewPhNum(int row) const = 0;
+	virtual std::span<const float> viewPhDur(int row) const = 0;
+	virtual std::span<const symbol> viewNoteSeq(int row) const = 0;
+	virtual std::span<const float> viewNoteTime(int row) const = 0;
+	virtual std::span<const int> viewNoteSlur(int row) const = 0;
+	virtual std::span<const float> viewOffset() const = 0;
+	virtual std::span<const float> viewCurve(curve_type type, int row) const = 0;	// ߲ʱΪ
+	// رŶӦĴǰ׺ıţ"zh/a" getPhSeq Ĺһ£ͣػδʱԭ
+	// ÿֻ״λʱǼһΣֱ֮Ӳ
+	virtual symbol langSymbol(symbol ph) const = 0;
+
+	// ߴĲʱزָ j ֡ȡʱ j * step ֵĩβ֮һ
+	// ֡Ϊ round( * ʱ / step)߲ڻ step <= 0 ʱؿգʱδ֪ʱԭ
+	virtual std::vector<float> getCurveStep(curve_type type, int row, float step, interp_mode mode = interp_mode::linear) const = 0;
+	// ȫ
+	virtual std::vector<std::vector<float>> getCurveStep(curve_type type, float step, interp_mode mode = interp_mode::linear) const = 0;
+	// ȫеȫߣ [][curve_type] 
+	virtual std::vector<std::array<std::vector<float>, curve_count>> getCurvesStep(float step, interp_mode mode = interp_mode::linear) const = 0;
+
 };
 
+//  DS ıʱĽʽ
+enum class load_mode {
+	dom,	// ȹ JSON DOM load() ʱٽ뵽
+	stream,	// ʽSAX߶У DOMΪѼ״̬
+			// δֶ֪λԭֻҪлgetsplitʱɸؽ DOM
+	lazy,	//  DOM ÿеֶΣֶ״ζȡʱŽ룬֮󻺴
+			// ߳ͬʱȡǰȫģ load() κ޸Ĳȫֶ
+};
+
+//  DS ıı޷ʱõն󣬲׳쳣
 music* get_music(
 	const std::string& json,
+	const std::string& language,
+	load_mode mode = load_mode::dom
+);
+
+// Ӷ DS 󣬴ΪѼ״̬
+// ݲϷʱ׳ DsParserError
+music* get_music_from_binary(
+	const std::string& data,
 	const std::string& language
 );
 
+// DS ı DS ת
+//  DS ֶŸеݣűȡʱٽı
+// תʧݣph_num ԭı棬ԭûʱ ph_seq ֣ԭûеֶתͬûУδֶ֪ԭ
+// ݲϷ޷ DS ıʱ׳ DsParserError
+std::string ds_to_binary(const std::string& json);
+std::string binary_to_ds(const std::string& data);
+
+//  DS ļļڴӳ䷽ʽȡַ
+// ļΪ DS ʱ modeֱӴӳжȡ
+// - dom˽едʱӳԭؽַٿ
+// - lazy dom ͬӳ䱣٣ֶΰӳн
+// - streamֻӳʽɺͷӳ
+// ޷򿪻ӳļʱ׳ DsParserError
+music* get_music_from_file(
+	const std::string& path,
+	const std::string& language,
+	load_mode mode = load_mode::dom
+);
+
 music* get_music(
 	const std::string& language
 );
 
 bool is_vowel(std::string noteNum);
+
+// ߻㣬ߣͬһڴ棨ԭת
+// ֻн϶̵ĳȣ MIDI ƵǾȷֵ
+// ֡Ƶ <= 0Ϊ MIDI 0ƫΪ 0NaN ԭ
+void midi_to_hz(std::span<const float> midi, std::span<float> hz);
+void hz_to_midi(std::span<const float> hz, std::span<float> midi);
+// ÿ֡ƵԲο MIDI ߣ getMidiStep ĽƫƣλΪ
+void hz_to_cents(std::span<const float> hz, std::span<const float> midi, std::span<float> cents);
+
+// зֺе֡֡Ϊ step splitLongRows ĽƴԭʼУذԭʼеĽ
+// ÿȡԭʼռݵ֡֡һ֡ûнĶ 0
+// outputs  plan.pieces ʱ׳ DsParserError
+std::vector<std::vector<float>> stitch_rows(const split_plan& plan, const std::vector<std::vector<float>>& outputs, float step);
+
+// ȷͰ make_batches
+struct batch_options {
+	float step = 512.0f / 44100.0f;			// ֡룩 getMidiStepgetCurveStep  step ͬ
+	size_t max_rows = 32;					// ÿ B
+	size_t max_frames = 0;					// ÿ B * T ޣ0 ΪޣһгʱԳһ
+	interp_mode mode = interp_mode::linear;	// ز step õĲֵ
+};
+
+// еһԵڼĵڼ
+struct batch_row {
+	size_t song = 0;
+	int row = 0;
+};
+
+// һݣ[B, T] Ļţ b е t Ԫλ b * T + tֱΪĴ洢
+// λΪ 0֣Ϊ 1 λЧ
+struct tensor_batch {
+	size_t rows = 0;			// B
+	size_t phonemes = 0;		// άĳ T_phһе
+	size_t frames = 0;			// ֡άĳ Tһе֡
+	std::vector<batch_row> source;		// [B]
+
+	std::vector<int64_t> ph_length;		// [B] е
+	std::vector<int64_t> ph_ids;		// [B, T_ph] ǰ׺رţlangSymbolֻڱЧ
+	std::vector<float> ph_dur;			// [B, T_ph] ʱ룩
+	std::vector<int64_t> ph_frames;		// [B, T_ph] ʱ֡ۼʱȡزᶪ֡ص
+	std::vector<uint8_t> ph_mask;		// [B, T_ph]
+
+	std::vector<int64_t> frame_length;	// [B] е֡ getMidiStep ĳ
+	std::vector<float> midi;			// [B, T] getMidiStep
+	std::vector<uint8_t> frame_mask;	// [B, T]
+	//  [B, T] curve_type УûκһиʱΪ
+	// ز֡һ֡֡Ľض
+	std::array<std::vector<float>, curve_count> curves;
+	std::array<std::vector<uint8_t>, curve_count> has_curve;	// [B] ǷߣûеΪ 0
+
+	double padding = 0.0;		// ֡άռı
+};
+
+// һȫа֡ͰͬһڣȰԭ˳ٵö
+// ΰһе֡СУstep <= 0  max_rows Ϊ 0 ʱ׳ DsParserError
+// ֻȡݣload_mode::dom ʽĶ load()
+std::vector<tensor_batch> make_batches(std::span<const music* const> songs, const batch_options& options = {});
+std::vector<tensor_batch> make_batches(const music& song, const batch_options& options = {});
 }
\ No newline at end of file
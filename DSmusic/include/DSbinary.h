@@ -0,0 +1,104 @@
+#pragma once
+#include "DSfield.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace DS {
+	// DS Ƹʽ
+	// 븡ΪС򣬸㰴 8 ֽڶ룬ֱڴӳ϶ȡ
+	//
+	// binary::header
+	// 	binary::slice[rows][field_count]ÿÿֶڸֶݶеλ
+	// ֶ	ÿֶһΣβӣֶַδűţ float  int32
+	// ű	uint32 ƫ[symbols + 1]֮ȫŵַ
+	// 	uint32 ƫ[rows + 1]֮ÿδֶ֪ɵ JSON ıΪգ
+	namespace binary {
+		constexpr std::array<char, 4> magic = { 'D', 'S', 'B', '\0' };
+		constexpr uint32_t version = 1;
+
+		// ֶݶεԪ
+		enum class element : uint8_t {
+			symbol,	// uint32 ű
+			f32,	// float
+			i32,	// int32
+		};
+
+		constexpr element element_of(field f) noexcept {
+			switch (f) {
+			case field::ph_seq:
+			case field::note_seq:
+				return element::symbol;
+			case field::ph_num:
+			case field::note_slur:
+				return element::i32;
+			default:
+				return element::f32;	//  offset*_timestepÿһԪ
+			}
+		}
+
+		constexpr size_t element_size = 4;
+
+		// ļڵһΣֽڼ
+		struct section {
+			uint64_t offset;
+			uint64_t size;
+		};
+
+		struct header {
+			std::array<char, 4> magic;
+			uint32_t version;
+			uint32_t rows;
+			uint32_t symbols;
+			section index;
+			std::array<section, field_count> fields;
+			section symbolOffsets;
+			section symbolData;
+			section extraOffsets;
+			section extraData;
+		};
+
+		// ĳĳֶֶݶеԪطΧcount Ϊ 0 ʾûֶ
+		struct slice {
+			uint32_t first;
+			uint32_t count;
+		};
+	}
+
+	//  DS ֻͼ
+	// ʱУͷȫϷʱ׳ DsParserError
+	class binary_reader {
+	public:
+		// ǷԶ DS ıʶͷ
+		static bool detect(const char* data, size_t size) noexcept;
+
+		binary_reader(const char* data, size_t size);
+
+		size_t rows() const { return _header->rows; }
+		size_t symbols() const { return _header->symbols; }
+
+		// ĳĳֶεԪأT  binary::element_of(f) һ£
+		// symbol Ϊ uint32_tf32 Ϊ floati32 Ϊ int32_t
+		template<typename T>
+		std::span<const T> values(size_t row, field f) const {
+			const binary::slice& s = _index[row * field_count + static_cast<size_t>(f)];
+			return { reinterpret_cast<const T*>(_data + _header->fields[static_cast<size_t>(f)].offset) + s.first, s.count };
+		}
+
+		// űԽʱ׳ DsParserError
+		std::string_view symbol(uint32_t id) const;
+
+		// ĳδֶ֪ε JSON ıûʱΪ
+		std::string_view extra(size_t row) const;
+
+	private:
+		const char* _data;
+		const binary::header* _header;
+		const binary::slice* _index;
+		const uint32_t* _symbolOffsets;
+		const uint32_t* _extraOffsets;
+	};
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "DSmusic.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <forward_list>
+#include <iterator>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+namespace DS {
+	// ÿЩм parser жӦķ
+	enum class feature : uint8_t {
+		midi_step,	// getMidiStepnote_seqnote_dur
+		pitch_step,	// getPitchStepf0_seqf0_timestepnote_seqnote_dur
+		midi_ph,	// getMidiPhnote_seqph_seq
+		note_dur,	// getNoteDur(row, step)note_dur
+		count
+	};
+
+	constexpr size_t feature_count = static_cast<size_t>(feature::count);
+
+	// ϣڰ޸ĵоȷʧЧ
+	using feature_mask = uint8_t;
+	constexpr feature_mask feature_bit(feature f) { return feature_mask(1) << static_cast<size_t>(f); }
+	constexpr feature_mask features_all = (feature_mask(1) << feature_count) - 1;
+
+	//  (, , ) 
+	// ʱֱӷѱУټҲڴ
+	// ÿÿֻ max_steps ֲ == Ƚϣ仯Ĳû
+	// صڸжӦʧЧinvalidateclear򱻸µĲ֮ǰһֱЧ
+	// ѯԶ߳ͬʱУʧЧֻ޸ʱȡͬʱ
+	class feature_cache {
+	public:
+		static constexpr size_t max_steps = 4;
+
+		// ȡû棬ûʱ make() 㲢
+		// make ִУ׳쳣ʱ棻߳ͬʱδʱֻȱĽ
+		template<typename F>
+		const std::vector<float>& get(size_t row, feature f, float step, F&& make) {
+			{
+				std::shared_lock lock(_mutex);
+				if (const std::vector<float>* hit = find(row, f, step)) {
+					_hits.fetch_add(1, std::memory_order_relaxed);
+					return *hit;
+				}
+			}
+			_misses.fetch_add(1, std::memory_order_relaxed);
+			std::vector<float> value = make();
+
+			std::unique_lock lock(_mutex);
+			if (const std::vector<float>* hit = find(row, f, step)) return *hit;
+			if (row >= _rows.size()) _rows.resize(row + 1);
+			auto& slot = _rows[row][static_cast<size_t>(f)];
+			slot.emplace_front(step, std::move(value));
+			// µǰ max_steps ֮
+			auto last = slot.begin();
+			for (size_t i = 1; i < max_steps && std::next(last) != slot.end(); ++i) ++last;
+			slot.erase_after(last, slot.end());
+			return slot.front().second;
+		}
+
+		// ĳеĲ
+		void invalidate(size_t row, feature_mask features) {
+			std::unique_lock lock(_mutex);
+			if (row >= _rows.size()) return;
+			for (size_t f = 0; f < feature_count; ++f) {
+				if (features & (feature_mask(1) << f)) _rows[row][f].clear();
+			}
+		}
+		// ȫ棬еĻַ仯 packʱʹ
+		void clear() {
+			std::unique_lock lock(_mutex);
+			_rows.clear();
+		}
+
+		cache_stats stats() const {
+			return { _hits.load(std::memory_order_relaxed), _misses.load(std::memory_order_relaxed) };
+		}
+
+	private:
+		// ͬһͬһֻͨһֲ棬ʱԪصַ
+		using entries = std::forward_list<std::pair<float, std::vector<float>>>;
+
+		const std::vector<float>* find(size_t row, feature f, float step) const {
+			if (row >= _rows.size()) return nullptr;
+			for (const auto& entry : _rows[row][static_cast<size_t>(f)]) {
+				if (entry.first == step) return &entry.second;
+			}
+			return nullptr;
+		}
+
+		mutable std::shared_mutex _mutex;
+		std::deque<std::array<entries, feature_count>> _rows;	// deque ʱеĵַ
+		std::atomic<uint64_t> _hits = 0;
+		std::atomic<uint64_t> _misses = 0;
+	};
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace DS {
+	// DS ÿֶ֪
+	enum class field : uint8_t {
+		ph_seq,
+		ph_dur,
+		ph_num,
+		note_seq,
+		note_dur,
+		note_slur,
+		offset,
+		f0_seq,
+		f0_timestep,
+		energy,
+		energy_timestep,
+		breathiness,
+		breathiness_timestep,
+		voicing,
+		voicing_timestep,
+		tension,
+		tension_timestep,
+		mouth_opening,
+		mouth_opening_timestep,
+		count,
+		unknown = count
+	};
+
+	constexpr size_t field_count = static_cast<size_t>(field::count);
+
+	// ֶ˳ field һ
+	constexpr std::array<std::string_view, field_count> field_keys = {
+		"ph_seq",
+		"ph_dur",
+		"ph_num",
+		"note_seq",
+		"note_dur",
+		"note_slur",
+		"offset",
+		"f0_seq",
+		"f0_timestep",
+		"energy",
+		"energy_timestep",
+		"breathiness",
+		"breathiness_timestep",
+		"voicing",
+		"voicing_timestep",
+		"tension",
+		"tension_timestep",
+		"mouth_opening",
+		"mouth_opening_timestep",
+	};
+
+	constexpr std::string_view field_key(field f) noexcept {
+		return field_keys[static_cast<size_t>(f)];
+	}
+
+	// ֶμ¼λϣÿһ uint32_tиֶελ
+	constexpr uint32_t field_bit(field f) noexcept {
+		return uint32_t(1) << static_cast<size_t>(f);
+	}
+
+	namespace detail {
+		constexpr size_t field_hash_size = 64;
+
+		// ֻȺֶַ޳ͻ· static_assert ֤
+		constexpr size_t field_hash(std::string_view key) noexcept {
+			const size_t n = key.size();
+			return (n * 7
+				+ static_cast<unsigned char>(key[0])
+				+ static_cast<unsigned char>(key[n - 1]) * 4
+				+ static_cast<unsigned char>(key[n / 2])) & (field_hash_size - 1);
+		}
+
+		constexpr std::array<field, field_hash_size> make_field_table() {
+			std::array<field, field_hash_size> table{};
+			for (auto& slot : table) slot = field::unknown;
+			for (size_t i = 0; i < field_count; ++i) {
+				table[field_hash(field_keys[i])] = static_cast<field>(i);
+			}
+			return table;
+		}
+
+		constexpr bool field_table_is_perfect() {
+			auto table = make_field_table();
+			for (size_t i = 0; i < field_count; ++i) {
+				if (table[field_hash(field_keys[i])] != static_cast<field>(i)) return false;
+			}
+			return true;
+		}
+
+		constexpr auto field_table = make_field_table();
+		static_assert(field_table_is_perfect(), "field_hash collides, adjust the hash");
+	}
+
+	// ֶֶΣδֶ֪η field::unknown
+	// һιϣ + һαȽϣֶ޹
+	constexpr field find_field(std::string_view key) noexcept {
+		if (key.empty()) return field::unknown;
+		field f = detail::field_table[detail::field_hash(key)];
+		if (f == field::unknown || field_key(f) != key) return field::unknown;
+		return f;
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace DS {
+	// ڴӳ䷽ʽ򿪵ֻļ
+	// ʧʱ׳ DsParserError
+	class mapped_file {
+	public:
+		enum class access {
+			read_only,		// ֻӳ
+			copy_on_write,	// ˽ӳ䣺ддֻӰ챾̣дļ
+		};
+
+		mapped_file(const std::string& path, access mode);
+		~mapped_file();
+
+		mapped_file(const mapped_file&) = delete;
+		mapped_file& operator=(const mapped_file&) = delete;
+
+		const char* data() const { return _data; }
+		char* data() { return _data; }
+		size_t size() const { return _size; }
+		bool empty() const { return _size == 0; }
+
+		// data()[size()] ɶΪ 0
+		// ļȲҳСʱӳһҳʣಿϵͳ 0ֱӵַβ
+		bool terminated() const { return _terminated; }
+
+	private:
+		char* _data = nullptr;
+		size_t _size = 0;
+		bool _terminated = false;
+
+#ifdef _WIN32
+		void* _file = nullptr;
+		void* _mapping = nullptr;
+#else
+		int _fd = -1;
+#endif
+	};
+}
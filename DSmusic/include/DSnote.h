@@ -0,0 +1,72 @@
+#pragma once
+#include <climits>
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+namespace DS {
+	// ޷ʱ note_to_midi ķֵ
+	constexpr int note_invalid = INT_MIN;
+
+	namespace detail {
+		// ĸӦĸʱ -1
+		constexpr int note_letter(char c) noexcept {
+			switch (c) {
+			case 'C': return 0;
+			case 'D': return 2;
+			case 'E': return 4;
+			case 'F': return 5;
+			case 'G': return 7;
+			case 'A': return 9;
+			case 'B': return 11;
+			default: return -1;
+			}
+		}
+	}
+
+	// ת MIDI ţڴ棬ڱֵ
+	// ɵĲʵһ£
+	// - Ϊĸӿѡ #  b֮ǰ˶ȣ˶ȿΪ˶ȺĶַ
+	// - CbB# ˶ȣд˶ȼ㣨Cb4 Ϊ 71B#4 Ϊ 60
+	constexpr int note_to_midi(std::string_view name) noexcept {
+		if (name.empty()) return note_invalid;
+		int pitch = detail::note_letter(name[0]);
+		if (pitch < 0) return note_invalid;
+
+		size_t i = 1;
+		if (i < name.size()) {
+			if (name[i] == '#') { pitch += 1; ++i; }
+			else if (name[i] == 'b') { pitch += 11; ++i; }
+		}
+		pitch %= 12;
+
+		bool negative = false;
+		if (i < name.size() && name[i] == '-') {
+			negative = true;
+			++i;
+		}
+		if (i == name.size() || name[i] < '0' || name[i] > '9') return note_invalid;
+
+		int octave = 0;
+		for (; i < name.size() && name[i] >= '0' && name[i] <= '9'; ++i) {
+			octave = octave * 10 + (name[i] - '0');
+			if (octave > 1000) return note_invalid;	// Զ MIDI Χ
+		}
+		if (negative) octave = -octave;
+		return (octave + 1) * 12 + pitch;
+	}
+
+	static_assert(note_to_midi("A4") == 69 && note_to_midi("C-1") == 0 && note_to_midi("Db4") == note_to_midi("C#4"));
+
+	// תд out޷λд note_invalid
+	// out  names ʱֻתǰ out.size() 
+	inline void note_to_midi(std::span<const std::string_view> names, std::span<int> out) noexcept {
+		const size_t n = names.size() < out.size() ? names.size() : out.size();
+		for (size_t i = 0; i < n; ++i) {
+			// زɴͬɣǰһָͬһַʱֱ
+			out[i] = (i > 0 && names[i].data() == names[i - 1].data() && names[i].size() == names[i - 1].size())
+				? out[i - 1]
+				: note_to_midi(names[i]);
+		}
+	}
+}
@@ -1,11 +1,20 @@
 #pragma once
 #include "DSmusic.h"
+#include "DSfield.h"
+#include "DSfile.h"
+#include "DSbinary.h"
+#include "DSsymbol.h"
+#include "DScache.h"
 
 #include "rapidjson/document.h"
 #include "rapidjson/error/en.h"
 
 #include <vector>
 #include <string>
+#include <sstream>
+#include <memory>
+#include <atomic>
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -20,33 +29,80 @@ namespace DS {
 		"SP", "AP"
 	};
 
+	class stream_handler;
+	class row_view;
+
 	class parser : public music {
+		friend class stream_handler;
+		friend class row_view;
 	public:
 		// 캯------------------------------------
 		
 		// е DS ṹȡ
 		parser(
 			const std::string& json,
+			const std::string& language,
+			load_mode mode = load_mode::dom
+		);
+		// ڴӳ DS ļȡ
+		// dom ʽԭؽӳͬڣstream ʽ꼴ͷӳ
+		parser(
+			std::unique_ptr<mapped_file> file,
+			const std::string& language,
+			load_mode mode = load_mode::dom
+		);
+		// Ӷ DS ȡֱֶݶοΪѼ״̬
+		parser(
+			const binary_reader& reader,
 			const std::string& language
 		);
 		// һյ DS
 		parser(
 			const std::string& language
 		);
+		// һ [first, first + count) УΪѼ״̬
+		// source ȫ루load ֮
+		parser(
+			const parser& source,
+			size_t first,
+			size_t count
+		);
 
 		// ʼҪֶβ洢ڳԱ
 		void load();
+		// гʼзָ parallelism ߳̽룬0 ʾʹӲ߳
+		void load(unsigned parallelism);
 
 		// δ GPU 
-		void pack(float time_s, float maxIntervalS);
+		void pack(float time_s, float maxIntervalS, const pack_options& options = {});
 
 		std::vector<std::string> pack(
 			float time_s,
 			float maxInterval_s,
-			const std::vector<std::string>& word_seq
+			const std::vector<std::string>& word_seq,
+			const pack_options& options = {}
+		);
+
+		pack_plan planPack(float time_s, float maxInterval_s, const pack_cost& cost = {}) const;
+		pack_plan planPackBalanced(double budget, float maxInterval_s, const pack_cost& cost = {}) const;
+
+		void pack(const pack_plan& plan, const pack_options& options = {});
+		std::vector<std::string> pack(
+			const pack_plan& plan,
+			const std::vector<std::string>& word_seq,
+			const pack_options& options = {}
+		);
+
+		std::unique_ptr<music> packed(const pack_plan& plan, const pack_options& options = {}) const;
+		void scatter(
+			const pack_plan& plan,
+			curve_type type,
+			const std::vector<std::vector<float>>& outputs,
+			float step
 		);
 
 		std::vector<std::unique_ptr<music>> split();
+		split_plan splitLongRows(float max_s, bool prefer_breaks = true);
 
 		// ڴмݣ
 		// ؼسɹı־
@@ -99,9 +155,16 @@ namespace DS {
 
 		// л
 		std::string get()const ;
+		// ɸֱ DS ı
+		void write(std::string& out, const write_options& options = {}) const;
+		void write(std::ostream& out, const write_options& options = {}) const;
+		// лΪ DSδʱȼ
+		std::string getBinary() const;
 
 		// ǷΪ
 		bool empty() const { return !_hasData; }
+		//  DS ı޷ʱն
+		bool parseFailed() const { return _parseFailed; }
 
 		// ȡ ds ļе
 		int getRowCount() const;
@@ -109,28 +172,30 @@ namespace DS {
 		// ȡ
 		std::vector<std::string> getPhSeq(int row) const;
 		std::vector<std::string> getPhSeq_raw(int row) const;
+		const std::vector<symbol>& getPhIds(int row) const { touch(row, field::ph_seq); return _phSeq.at(row); }
 
 		// ȡÿڵ
-		std::vector<int> getPhNum(int row) const { return _phNum.at(row); }
+		std::vector<int> getPhNum(int row) const { touch(row, field::ph_num); return _phNum.at(row); }
 
 		// ȡ
-		std::vector<std::string> getNoteSeq(int row) const { return _noteSeq.at(row); }
+		std::vector<std::string> getNoteSeq(int row) const { touch(row, field::note_seq); return symbol_names(_noteSeq.at(row)); }
+		const std::vector<symbol>& getNoteIds(int row) const { touch(row, field::note_seq); return _noteSeq.at(row); }
 
 		// ȡʱ
-		std::vector<float> getNoteTime(int row) const { return _noteTime.at(row); }
-		std::vector<float> getNoteDur(int row, float step) const;
+		std::vector<float> getNoteTime(int row) const { touch(row, field::note_dur); return _noteTime.at(row); }
+		const std::vector<float>& getNoteDur(int row, float step) const;
 
 		// ȡ־
-		std::vector<int> getNoteSlur(int row) const { return _noteSlur.at(row); }
+		std::vector<int> getNoteSlur(int row) const { touch(row, field::note_slur); return _noteSlur.at(row); }
 
 		// ȡĳеƫʱ
-		float getOffset(int row) const { return _offset.at(row); }
+		float getOffset(int row) const { touch(row, field::offset); return _offset.at(row); }
 
 		// ȡȫеƫʱ
-		std::vector<float> getOffset() const { return _offset; }
+		std::vector<float> getOffset() const { touchAll(field::offset); return _offset; }
 
 		// ȡʱ
-		float getTickTime(int row = 0) const { return _f0_ticktime.at(row); }
+		float getTickTime(int row = 0) const { touch(row, field::f0_timestep); return _f0_ticktime.at(row); }
 
 		// ȡ
 		std::string getLang() const { return _language; }
@@ -139,73 +204,106 @@ namespace DS {
 		parser& setPitch(std::vector<float> data, float offset, int row);
 		// ȡ
 		const std::vector<float> getPitch(int row) const;
-		const std::vector<float> getPitchStep(int row, float step) const;
+		const std::vector<float>& getPitchStep(int row, float step) const;
 		const std::vector<float> getMidi(int row) const;
-		const std::vector<float> getMidiPh(int row) const;
-		const std::vector<float> getMidiStep(int row, float step) const;
+		const std::vector<float>& getMidiPh(int row) const;
+		const std::vector<float>& getMidiStep(int row, float step) const;
+
+		// 
+		cache_stats getCacheStats() const { return _cache.stats(); }
+		void clearCache() { _cache.clear(); }
 
 		// ʱ
 		parser& setPhTime(std::vector<float> data, float offset, int row);
 		// ȡʱ
-		const std::vector<float>& getPhDur(int row) const { return _phTime.at(row); }
+		const std::vector<float>& getPhDur(int row) const { touch(row, field::ph_dur); return _phTime.at(row); }
 
 		// 
 		parser& setEnergy(std::vector<float> data, float offset, int row);
 		// ȡ
-		const std::vector<float>& getEnergy(int row) const { 
-			if (_energy.empty()) return{};
-			return _energy.at(row); 
-		}
+		const std::vector<float>& getEnergy(int row) const { touch(row, field::energy); return curve(_energy, row); }
 
 		// 
 		parser& setBreathiness(std::vector<float> data, float offset, int row);
 		// ȡ
-		const std::vector<float>& getBreathiness(int row) const { 
-			if (_breathiness.empty()) return{};
-			return _breathiness.at(row); 
-		}
+		const std::vector<float>& getBreathiness(int row) const { touch(row, field::breathiness); return curve(_breathiness, row); }
 
 		// ÷
 		parser& setVoicing(std::vector<float> data, float offset, int row);
 		// ȡ
-		const std::vector<float>& getVoicing(int row) const { 
-			if (_voicing.empty()) return{};
-			return _voicing.at(row); 
-		}
+		const std::vector<float>& getVoicing(int row) const { touch(row, field::voicing); return curve(_voicing, row); }
 
 		// 
 		parser& setTension(std::vector<float> data, float offset, int row);
 		// ȡ
-		const std::vector<float>& getTension(int row) const { 
-			if (_tension.empty()) return{};
-			return _tension.at(row); 
-		}
+		const std::vector<float>& getTension(int row) const { touch(row, field::tension); return curve(_tension, row); }
 
 		// ÿ
 		parser& setMouthOpening(std::vector<float> data, float offset, int row);
 		// ȡ
-		const std::vector<float>& getMouthOpening(int row) const {
-			if (_mouthOpening.empty()) return{};
-			return _mouthOpening.at(row);
-		}
+		const std::vector<float>& getMouthOpening(int row) const { touch(row, field::mouth_opening); return curve(_mouthOpening, row); }
+
+		// ֻͼ
+		std::span<const symbol> viewPhSeq(int row) const { touch(row, field::ph_seq); return _phSeq.at(row); }
+		std::span<const int> viewPhNum(int row) const { touch(row, field::ph_num); return _phNum.at(row); }
+		std::span<const float> viewPhDur(int row) const { touch(row, field::ph_dur); return _phTime.at(row); }
+		std::span<const symbol> viewNoteSeq(int row) const { touch(row, field::note_seq); return _noteSeq.at(row); }
+		std::span<const float> viewNoteTime(int row) const { touch(row, field::note_dur); return _noteTime.at(row); }
+		std::span<const int> viewNoteSlur(int row) const { touch(row, field::note_slur); return _noteSlur.at(row); }
+		std::span<const float> viewOffset() const { touchAll(field::offset); return _offset; }
+		std::span<const float> viewCurve(curve_type type, int row) const;
+		symbol langSymbol(symbol ph) const;
+
+		// ָز
+		std::vector<float> getCurveStep(curve_type type, int row, float step, interp_mode mode = interp_mode::linear) const;
+		std::vector<std::vector<float>> getCurveStep(curve_type type, float step, interp_mode mode = interp_mode::linear) const;
+		std::vector<std::array<std::vector<float>, curve_count>> getCurvesStep(float step, interp_mode mode = interp_mode::linear) const;
 
 	private:
-		bool _isLoad = false;	// Ѽصڴ棬ɵ get ϵзȡ
+		std::atomic<bool> _isLoad = false;	// Ѽصڴ棬ɵ get ϵзȡ
+		std::mutex _loadMutex;				// ֤ͬʱֻһ load ڽ
 		bool _hasData = false;	// пݣ json ڵĻڴе
 		bool _readyCase = false;// ʸѾ
-
-		rapidjson::Document _dsData;  // 洫 ds ļ
-		rapidjson::Document::AllocatorType* _allocator = nullptr;
+		bool _parseFailed = false;	// DS ı޷Ѱն
+
+		// 洫 ds ļ
+		// ʽʱҪлʱɸؽ dom()
+		mutable rapidjson::Document _dsData;
+		std::unique_ptr<mapped_file> _file;		// ԭؽʱ _dsData еַָ
+
+		// 
+		std::atomic<bool> _lazy = false;				// ֶδ
+		std::vector<const rapidjson::Value*> _index;	// ÿÿֶ _dsData еֵ
+		std::unique_ptr<std::once_flag[]> _decoded;		//  _index һһӦ
+		mutable std::atomic<bool> _domReady = true;	// _dsData ѹе޸Ŀδдأ _dirty
+		mutable std::vector<uint32_t> _dirty;	// ÿ޸Ĺδд _dsData ֶΣ field ŵλ
+		mutable std::atomic<bool> _anyDirty = false;
+		mutable std::mutex _domMutex;			// ֤ͬʱֻһ߳ڹ DOM д޸ģ dom()
+		// saveString ɵı_dsData жӦֱֵдʱûз
+		mutable std::vector<std::unique_ptr<std::array<std::string, field_count>>> _fieldText;
+		// _dsData ڴб滻޷ͷŵֵֵֽʱ
+		mutable size_t _garbage = 0;
+		static constexpr size_t compact_threshold = size_t(1) << 20;
+		std::vector<std::string> _extraJson = {};	// ʽʱδֶ֪Σÿһ JSON 󣻲ǶΪеֵ
+		// ÿԭûеֶ֪Σÿֶһλɸؽʱ޸ĸֶκ
+		// ֻҪΪվͲҪܻ offset  ph_seq ֳ ph_num
+		std::vector<uint32_t> _absent = {};
 
 		std::string _language; // ʹõ
+		// ԵĻã״ε langSymbol ʱȡ
+		mutable std::once_flag _langOnce;
+		mutable lang_table* _langTable = nullptr;
+
+		mutable feature_cache _cache;	// getPitchStep Ļ棬޸ʱʧЧ
+		std::weak_ptr<const parser> _splitStore;	// split صĸйֻʹδ޸ʱ
 
 		// ڲݴ洢
-		std::vector<std::vector<std::string>> _phSeq = {};	// 
+		std::vector<std::vector<symbol>> _phSeq = {};		// 
 		std::vector<std::vector<int>> _phNum = {};			// ڻ
 		std::vector<std::vector<int>> _noteSlur = {};		// ־
 		std::vector<float> _offset = {};					// ƫʱ
 
-		std::vector<std::vector<std::string>> _noteSeq = {};// 
+		std::vector<std::vector<symbol>> _noteSeq = {};		// 
 		std::vector<std::vector<float>> _noteTime = {};		// ʱ
 
 		std::vector<std::vector<float>> _phTime = {};		// ʱ
@@ -230,23 +328,120 @@ namespace DS {
 
 		// ߺ----------------------------------------------------------------------------
 
-		//  ds ļȡӦֵ
+		// ʽ DS ıֱУ޷ʱΪղ false
+		bool loadStream(const char* json, size_t length);
+		// ɶ DS 
+		void loadBinary(const binary_reader& reader);
+		// ĳвܽ뵽еĳԱδֶ֪εȣһ JSON ıûʱΪ
+		// ԭһвǶʱеֵ
+		std::string extraJson(size_t row) const;
+		// extraJson ıгֵֶ֪Σֵ޷ԭУÿֶһλؽʱЩв
+		static uint32_t extraFields(std::string_view extra);
+		// ޸ĳеֶʱȥ _extraJson бԭֵΪ׼
+		void dropExtra(size_t row, field f);
+		// Ϊ rows зÿһ
+		void resizeColumns(size_t rows);
+		// ֶеĶӦл˳ÿֶ֪ε fn(field, )
+		// Ϊ std::vector<std::vector<T>>У std::vector<float>offset ʱ䣩
+		// лƶд resizeColumns űֶֻ
+		template<typename Self, typename F>
+		static void forEachColumn(Self& self, F&& fn) {
+			fn(field::ph_seq, self._phSeq);
+			fn(field::ph_num, self._phNum);
+			fn(field::note_seq, self._noteSeq);
+			fn(field::note_dur, self._noteTime);
+			fn(field::note_slur, self._noteSlur);
+			fn(field::ph_dur, self._phTime);
+			fn(field::offset, self._offset);
+			fn(field::f0_seq, self._f0_seq);
+			fn(field::f0_timestep, self._f0_ticktime);
+			fn(field::energy, self._energy);
+			fn(field::energy_timestep, self._energy_ticktime);
+			fn(field::breathiness, self._breathiness);
+			fn(field::breathiness_timestep, self._breathiness_ticktime);
+			fn(field::voicing, self._voicing);
+			fn(field::voicing_timestep, self._voicing_ticktime);
+			fn(field::tension, self._tension);
+			fn(field::tension_timestep, self._tension_ticktime);
+			fn(field::mouth_opening, self._mouthOpening);
+			fn(field::mouth_opening_timestep, self._mouthOpening_ticktime);
+		}
+		// 룺ÿиֶ DOM еλã״ηʱŽ
+		void indexRows();
+		// ȷĳеĳֶѽ룬߳ͬʱ״ηʱֻһ
+		void touch(size_t row, field f) const;
+		void touchAll(field f) const;
+		// ģʽ£޸ǰȽȫֶ
+		void settle() { if (_lazy.load(std::memory_order_acquire)) load(); }
+		// ȡߣ岻ʱؿ
+		static const std::vector<float>& curve(const std::vector<std::vector<float>>& column, int row);
+		// ߶ӦĳеĲʱ䣬ʱδʱΪ 0
+		const std::vector<std::vector<float>>& curveColumn(curve_type type) const;
+		float curveTimestep(curve_type type, int row) const;
+		// αһеȫԱֶɵӦеĽ
+		void decodeRow(size_t row);
+		// һֶεֵ뵽ӦУֵַ
+		void decodeField(size_t row, field f, const rapidjson::Value& value);
+		// ȡ DOMδʱɸؽ޸ʱд
+		// д _domMutex ڽֻһΣ֮߳̿ͬʱȡص DOM
+		rapidjson::Document& dom() const;
+		void buildDom() const;
+		// һе DS ıһ JSON ׷ӵ out
+		void writeRow(std::string& out, size_t row, int precision) const;
+		// ֵֶַհ׷ִʣֱȡֵ
 		template <typename T>
-		std::vector<T> parseDS(const std::string& key, size_t index);
-		// Ϊ
+		static void parseDS(const rapidjson::Value& value, std::vector<T>& out);
+		// ֵֶΣoffset*_timestep޷ʱ 0
+		static float parseScalar(const rapidjson::Value& value);
+		// ĳĳֶ޸ģֻ¼ıлdom()ʱд _dsData
+		void markDirty(size_t row, field f);
+		// ޸Ĺֶд _dsData
+		void flushDirty() const;
+		// Ϊֶ֣Ѵʱԭ滻
 		template<typename T>
-		parser& saveNumber(const std::string& key, const T& value, size_t index);
-		// Ϊַ
+		void saveNumber(field f, const T& value, size_t index) const;
+		// ΪֶַѴʱԭ滻ıθ
 		template<typename T>
-		parser& saveString(const std::string& key, const T& value, size_t index);
+		void saveString(field f, const T& value, size_t index) const;
+		// ĳеֶΣͬԱʱ滻ֵ
+		// owned ΪСڴеľıַ滻
+		void setMember(size_t row, field f, rapidjson::Value& value, const char* owned = nullptr) const;
+		//  _dsData ڴأµĿ
+		void resetDom() const;
+		//  _dsData µڴУͷű滻ľֵ
+		void compact() const;
+
+		// 滮õÿͳƣʱǷ SP β
+		struct pack_rows {
+			std::vector<float> total;
+			std::vector<size_t> phonemes;
+			std::vector<bool> restEnd;
+		};
+		pack_rows packRows() const;
+		// ۼʱÿԭʼеλãplan.rows
+		void placeRows(pack_plan& plan, const pack_rows& rows) const;
+		// 鷽˳ز©ظȫ
+		void checkPlan(const pack_plan& plan) const;
+		//  from ĸУδֶ֪Σ滻ݣеĻ֮ı䣬 DOM һʧЧ
+		void adoptColumns(parser& from);
+		// Ѹкϲд out ĸУغϲĸʣȫ
+		std::vector<std::string> mergeRows(
+			parser& out,
+			const pack_plan& plan,
+			const std::vector<std::string>& word_seq,
+			const pack_options& options
+		) const;
 
 		// 
-		std::vector<int> makePhNum(const std::vector<std::string>& ph_seq);
+		std::vector<int> makePhNum(const std::vector<symbol>& ph_seq) const;
+		// ԭû ph_num ʱ ph_seq ֣һе ph_num ԭ
+		void derivePhNum(size_t row);
+		uint32_t absentFields(size_t row) const { return row < _absent.size() ? _absent[row] : 0; }
 
 		// TODO ЩΪʱתʩתֺ֧Ӧɾ----------
 		// ӦתУµб
-		std::vector<std::string> makePhSeq(
-			const std::vector<std::string>& ph_seq,
+		std::vector<symbol> makePhSeq(
+			const std::vector<symbol>& ph_seq,
 			const std::vector<int>& note_slur
 		);
 		// 
@@ -256,21 +451,31 @@ namespace DS {
 		// - data_seq Ԫ
 		// - element_length_seq ÿԪռ
 		// - step ز
+		// ߽֡簴ۼʱȡ֡Ϊ round(ܳ / step) DSresample.h
 		template<typename T>
 		std::vector<T> resampling(
 			const std::vector<T>& data_seq,
 			const std::vector<float>& element_length_seq,
 			float step
 		) const;
+		// дṩĻ֡ʱֻдǰ out.size() ֡
+		template<typename T>
+		size_t resampling(
+			const std::vector<T>& data_seq,
+			const std::vector<float>& element_length_seq,
+			float step,
+			std::span<T> out
+		) const;
 
 		std::vector<float> P_F_conversion(
-			const std::vector<std::string>& notes
+			const std::vector<symbol>& notes
 		) const;
 
 		std::vector<float> P_M_conversion(
-			const std::vector<std::string>& notes
+			const std::vector<symbol>& notes
 		) const;
 
+		// еĻָıpack DOM´лʱɸؽ
 		void updateJSONData();
 		//------------------------------------------------------------------------
 
@@ -303,4 +508,7 @@ namespace DS {
 			}
 		}
 	};
+
+	// float תΪ double ʱʮƱʾDOM еֵ write() ƫơʱ䶼
+	double widen(float value);
 }
\ No newline at end of file
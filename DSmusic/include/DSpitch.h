@@ -0,0 +1,49 @@
+#pragma once
+#include <array>
+#include <cstddef>
+
+namespace DS {
+	namespace detail {
+		// 2^(k/12)k = 0..11
+		constexpr std::array<double, 12> semitone_ratio = {
+			1.0,
+			1.0594630943592953,
+			1.122462048309373,
+			1.189207115002721,
+			1.2599210498948732,
+			1.3348398541700344,
+			1.4142135623730951,
+			1.4983070768766815,
+			1.5874010519681994,
+			1.681792830507429,
+			1.7817974362806785,
+			1.8877486253633868,
+		};
+
+		// MIDI 0C-1Ƶʣ440 * 2^(-69/12)
+		constexpr double midi0_hz = 8.175798915643707;
+	}
+
+	// MIDI 0..11 Ƶʣ MIDI ƵΪ 2 
+	//  2 ݲ룬 MIDI ĽֱӼȡ float ͬ
+	constexpr std::array<float, 12> midi_octave_hz = [] {
+		std::array<float, 12> table{};
+		for (size_t s = 0; s < 12; ++s) {
+			table[s] = static_cast<float>(detail::midi0_hz * detail::semitone_ratio[s]);
+		}
+		return table;
+	}();
+
+	//  MIDI 0..127 ľȷƵ
+	constexpr std::array<float, 128> midi_hz_table = [] {
+		std::array<float, 128> table{};
+		for (size_t n = 0; n < 128; ++n) {
+			double hz = detail::midi0_hz * detail::semitone_ratio[n % 12];
+			for (size_t o = 0; o < n / 12; ++o) hz *= 2.0;
+			table[n] = static_cast<float>(hz);
+		}
+		return table;
+	}();
+
+	static_assert(midi_hz_table[69] == 440.0f && midi_hz_table[57] == 220.0f);
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "DSmusic.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace DS {
+	// ֡زԪصУأʱչɹ̶֡
+	// ߽֡ۼʱ i Ԫռ֡ [round(t_i / step), round(t_(i+1) / step))
+	// t_i Ϊǰ i ԪصۼʱÿԪص֡ڱ߽õۻ
+	// ֡Ϊ round(ʱ / step)
+	// ʱ <= 0 Ԫزռ֡Ҳƽʱ
+
+	// ζÿԪص run(index, first, count)count Ϊ 0
+	template<typename F>
+	void resample_runs(std::span<const float> lengths, float step, F&& run) {
+		const double inv = 1.0 / static_cast<double>(step);
+		double time = 0.0;
+		size_t edge = 0;
+		for (size_t i = 0; i < lengths.size(); ++i) {
+			if (lengths[i] > 0.0f) time += lengths[i];
+			const size_t next = static_cast<size_t>(std::llround(time * inv));
+			run(i, edge, next - edge);
+			edge = next;
+		}
+	}
+
+	// ز֡step <= 0 ʱΪ 0
+	inline size_t resample_size(std::span<const float> lengths, float step) {
+		if (step <= 0.0f) return 0;
+		double time = 0.0;
+		for (float length : lengths) {
+			if (length > 0.0f) time += length;
+		}
+		return static_cast<size_t>(std::llround(time / static_cast<double>(step)));
+	}
+
+	// дߵĻ֡out ʱֻдǰ out.size() ֡
+	// data  lengths Ȳһ» step <= 0 ʱд벢 0
+	template<typename T>
+	size_t resample(std::span<const T> data, std::span<const float> lengths, float step, std::span<T> out) {
+		if (data.size() != lengths.size() || step <= 0.0f) return 0;
+		size_t total = 0;
+		resample_runs(lengths, step, [&](size_t i, size_t first, size_t count) {
+			total = first + count;
+			if (first >= out.size()) return;
+			std::fill_n(out.begin() + first, std::min(count, out.size() - first), data[i]);
+		});
+		return total;
+	}
+
+	template<typename T>
+	std::vector<T> resample(std::span<const T> data, std::span<const float> lengths, float step) {
+		if (data.size() != lengths.size() || step <= 0.0f) return {};
+		std::vector<T> out(resample_size(lengths, step));
+		resample<T>(data, lengths, step, out);
+		return out;
+	}
+
+	// ز i λʱ i * timestep j ֡ȡʱ j * step ֵ
+	// һ֡һ
+
+	// ز֡ round(points * timestep / step)timestep  step <= 0 ʱΪ 0
+	size_t curve_frames(size_t points, float timestep, float step);
+
+	// дߵĻд out Ϊֹout Ա curve_frames 
+	// curve Ϊʱд
+	void resample_curve(std::span<const float> curve, float timestep, float step, interp_mode mode, std::span<float> out);
+
+	std::vector<float> resample_curve(std::span<const float> curve, float timestep, float step, interp_mode mode);
+
+	// ƴߵһΣ start һߣcurve Ϊձʾʱû
+	struct curve_piece {
+		std::span<const float> curve;
+		float timestep = 0.0f;
+		double start = 0.0;
+	};
+
+	// ѰʼʱеĸƴɲʱΪ step һ
+	//  k δӵ round(start / step) ֡ʼǰһصʱĩβ֮Ŀ϶ options 
+	// һûʱͬķʽ䵽 round(end / step) ֡
+	std::vector<float> splice_curves(std::span<const curve_piece> pieces, float step, double end, const pack_options& options);
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "DSmusic.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace DS {
+	// ŵķ־ǼʱƼһ
+	enum symbol_flag : uint8_t {
+		symbol_vowel = 1 << 0,	// Ԫ Vowel һ£ SPAP
+		symbol_pause = 1 << 1,	// ͣ SPAP
+		symbol_rest = 1 << 2,	// ֹ rest
+	};
+
+	// űŶС
+	constexpr size_t symbol_capacity = size_t(1) << 16;
+
+	// ԤȵǼǡŹ̶ķ
+	namespace symbols {
+		constexpr symbol SP{ 0 };
+		constexpr symbol AP{ 1 };
+		constexpr symbol rest{ 2 };
+	}
+
+	// ȫַűãֻ 65536 
+	// ǼѯԶ߳ͬʱ
+	class symbol_table {
+	public:
+		static symbol_table& global();
+
+		// ȡƶӦıţ״γʱǼǣʱ׳ DsParserError䣬ѵǼǵճ
+		symbol intern(std::string_view name);
+
+		// ²ѯֻ internӦ䷵ǰд
+		std::string_view name(symbol id) const {
+			const size_t i = static_cast<size_t>(id);
+			return _names[i >> chunk_bits][i & chunk_mask];
+		}
+		uint8_t flags(symbol id) const { return _flags[static_cast<size_t>(id)]; }
+
+	private:
+		static constexpr size_t capacity = symbol_capacity;
+		static constexpr size_t chunk_bits = 8;
+		static constexpr size_t chunk_mask = (size_t(1) << chunk_bits) - 1;
+
+		symbol_table();
+
+		mutable std::shared_mutex _mutex;
+		std::unordered_map<std::string_view, symbol> _ids;	// ָ _names еַ
+		size_t _size = 0;
+		// ư䣬ѵǼǵַַ仯
+		std::array<std::unique_ptr<std::string[]>, (capacity >> chunk_bits)> _names;
+		std::array<uint8_t, capacity> _flags{};
+	};
+
+	inline uint8_t symbol_flags(symbol id) { return symbol_table::global().flags(id); }
+	inline bool is_vowel(symbol id) { return (symbol_flags(id) & symbol_vowel) != 0; }
+	inline bool is_pause(symbol id) { return (symbol_flags(id) & symbol_pause) != 0; }
+	inline bool is_rest(symbol id) { return (symbol_flags(id) & symbol_rest) != 0; }
+
+	// رŵǰ׺ "zh/a"ıŵĻ
+	// ÿһţɸԵжãűһֻͷ
+	// Զ߳ͬʱ
+	class lang_table {
+	public:
+		// ȡԶӦı״õʱ
+		static lang_table& of(const std::string& language);
+
+		symbol map(symbol ph);
+
+	private:
+		explicit lang_table(const std::string& language);
+
+		std::string _prefix;	//  "/"
+		// ±꣬  + 10 ʾδ
+		std::array<std::atomic<uint32_t>, symbol_capacity> _ids{};
+	};
+
+	// лת
+	std::vector<symbol> intern_symbols(const std::vector<std::string>& names);
+	std::vector<std::string> symbol_names(const std::vector<symbol>& ids);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "DSsymbol.h"
+
+#include <algorithm>
+#include <charconv>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace DS {
+	// ָ istringstream Ŀհ׹򱣳һ
+	inline bool is_delimiter(char c) noexcept {
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+	}
+
+	// Կոָ token һԤ
+	// ֻո񣬱Խոʹƫ󣬵ƫС
+	inline size_t count_tokens(const char* first, const char* last) noexcept {
+		if (first == last) return 0;
+		return static_cast<size_t>(std::count(first, last, ' ')) + 1;
+	}
+
+	// Կհ׷ָв׷ӵ out
+	// ֱӶȡߵĻ rapidjson ַκмַ
+	// - ֵʹ std::from_chars
+	// - std::string  token ԭ
+	// - symbol Ǽǵȫַűֻ
+	// ޷ token ᱻɵ istringstream Ϊһ
+	template<typename T>
+	void tokenize(const char* first, const char* last, std::vector<T>& out) {
+		out.reserve(out.size() + count_tokens(first, last));
+
+		const char* p = first;
+		while (p != last) {
+			// ָ
+			while (p != last && is_delimiter(*p)) ++p;
+			if (p == last) break;
+
+			// ҵ token β
+			const char* end = p;
+			while (end != last && !is_delimiter(*end)) ++end;
+
+			if constexpr (std::is_same_v<T, std::string>) {
+				out.emplace_back(p, end);
+			}
+			else if constexpr (std::is_same_v<T, symbol>) {
+				out.push_back(intern_symbol({ p, static_cast<size_t>(end - p) }));
+			}
+			else {
+				static_assert(std::is_arithmetic_v<T>, "tokenize: unsupported element type");
+				// from_chars ǰ '+'
+				const char* begin = (*p == '+' && end - p > 1) ? p + 1 : p;
+				T value{};
+				auto [ptr, ec] = std::from_chars(begin, end, value);
+				if (ec == std::errc() && ptr != begin) {
+					out.push_back(value);
+				}
+			}
+			p = end;
+		}
+	}
+
+	template<typename T>
+	std::vector<T> tokenize(const char* first, const char* last) {
+		std::vector<T> out;
+		tokenize(first, last, out);
+		return out;
+	}
+}
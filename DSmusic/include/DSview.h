@@ -0,0 +1,143 @@
+#pragma once
+#include "DSparser.h"
+
+#include <memory>
+
+namespace DS {
+	// split صһУָйֻݣüȡʱֱתеһУ
+	// ״޸ģset ϵСpack ȣʱŰһиƳɶĶ֮ĶдڸϽУӰ
+	// δ޸ĵͼڶ߳ͬʱȡɹĸй
+	class row_view : public music {
+	public:
+		row_view(std::shared_ptr<const parser> store, size_t row);
+
+		// ȫ룬δ޸ʱ
+		void load() { if (_own) _own->load(); }
+		void load(unsigned parallelism) { if (_own) _own->load(parallelism); }
+
+		void pack(float time_s, float maxInterval_s, const pack_options& options = {});
+		std::vector<std::string> pack(
+			float time_s,
+			float maxInterval_s,
+			const std::vector<std::string>& word_seq,
+			const pack_options& options = {}
+		);
+		pack_plan planPack(float time_s, float maxInterval_s, const pack_cost& cost = {}) const;
+		pack_plan planPackBalanced(double budget, float maxInterval_s, const pack_cost& cost = {}) const;
+		void pack(const pack_plan& plan, const pack_options& options = {});
+		std::vector<std::string> pack(
+			const pack_plan& plan,
+			const std::vector<std::string>& word_seq,
+			const pack_options& options = {}
+		);
+		std::unique_ptr<music> packed(const pack_plan& plan, const pack_options& options = {}) const;
+		void scatter(
+			const pack_plan& plan,
+			curve_type type,
+			const std::vector<std::vector<float>>& outputs,
+			float step
+		);
+
+		std::vector<std::unique_ptr<music>> split();
+		split_plan splitLongRows(float max_s, bool prefer_breaks = true);
+
+		bool set(
+			const std::vector<std::string>& note_seq,
+			const std::vector<float>& note_dur,
+			const std::vector<int>& note_slur,
+			const std::vector<std::string>& ph_seq,
+			const std::vector<float>& ph_dur,
+			float offset = 0,
+			int row = 0
+		);
+		bool set(
+			const std::vector<std::string>& note_seq,
+			const std::vector<float>& note_dur,
+			const std::vector<int>& note_slur,
+			float offset = 0,
+			int row = 0
+		);
+		bool set_lyrics(
+			const std::vector<std::string>& ph_seq,
+			const std::vector<float>& ph_dur,
+			int row = 0
+		);
+
+		// лֶΰ̶˳ write ͬδֶ֪ǰ
+		std::string get() const;
+		void write(std::string& out, const write_options& options = {}) const;
+		void write(std::ostream& out, const write_options& options = {}) const;
+		std::string getBinary() const;
+
+		bool empty() const { return data().empty(); }
+		int getRowCount() const { return _own ? _own->getRowCount() : 1; }
+
+		std::vector<std::string> getPhSeq(int row) const { return data().getPhSeq(at(row)); }
+		std::vector<std::string> getPhSeq_raw(int row) const { return data().getPhSeq_raw(at(row)); }
+		const std::vector<symbol>& getPhIds(int row) const { return data().getPhIds(at(row)); }
+		std::vector<int> getPhNum(int row) const { return data().getPhNum(at(row)); }
+		std::vector<std::string> getNoteSeq(int row) const { return data().getNoteSeq(at(row)); }
+		const std::vector<symbol>& getNoteIds(int row) const { return data().getNoteIds(at(row)); }
+		std::vector<float> getNoteTime(int row) const { return data().getNoteTime(at(row)); }
+		const std::vector<float>& getNoteDur(int row, float step) const { return data().getNoteDur(at(row), step); }
+		std::vector<int> getNoteSlur(int row) const { return data().getNoteSlur(at(row)); }
+		float getOffset(int row) const { return data().getOffset(at(row)); }
+		std::vector<float> getOffset() const;
+		float getTickTime(int row = 0) const { return data().getTickTime(at(row)); }
+		std::string getLang() const { return data().getLang(); }
+
+		row_view& setPitch(std::vector<float> data, float offset, int row);
+		const std::vector<float> getPitch(int row) const { return data().getPitch(at(row)); }
+		const std::vector<float>& getPitchStep(int row, float step) const { return data().getPitchStep(at(row), step); }
+		const std::vector<float> getMidi(int row) const { return data().getMidi(at(row)); }
+		const std::vector<float>& getMidiPh(int row) const { return data().getMidiPh(at(row)); }
+		const std::vector<float>& getMidiStep(int row, float step) const { return data().getMidiStep(at(row), step); }
+
+		// δ޸ʱɹĸйãͳҲǹõģclearCache ֻͷ޸ĺԼĸĻ
+		cache_stats getCacheStats() const { return data().getCacheStats(); }
+		void clearCache() { if (_own) _own->clearCache(); }
+
+		row_view& setPhTime(std::vector<float> data, float offset, int row);
+		const std::vector<float>& getPhDur(int row) const { return data().getPhDur(at(row)); }
+		row_view& setEnergy(std::vector<float> data, float offset, int row);
+		const std::vector<float>& getEnergy(int row) const { return data().getEnergy(at(row)); }
+		row_view& setBreathiness(std::vector<float> data, float offset, int row);
+		const std::vector<float>& getBreathiness(int row) const { return data().getBreathiness(at(row)); }
+		row_view& setVoicing(std::vector<float> data, float offset, int row);
+		const std::vector<float>& getVoicing(int row) const { return data().getVoicing(at(row)); }
+		row_view& setTension(std::vector<float> data, float offset, int row);
+		const std::vector<float>& getTension(int row) const { return data().getTension(at(row)); }
+		row_view& setMouthOpening(std::vector<float> data, float offset, int row);
+		const std::vector<float>& getMouthOpening(int row) const { return data().getMouthOpening(at(row)); }
+
+		std::span<const symbol> viewPhSeq(int row) const { return data().viewPhSeq(at(row)); }
+		std::span<const int> viewPhNum(int row) const { return data().viewPhNum(at(row)); }
+		std::span<const float> viewPhDur(int row) const { return data().viewPhDur(at(row)); }
+		std::span<const symbol> viewNoteSeq(int row) const { return data().viewNoteSeq(at(row)); }
+		std::span<const float> viewNoteTime(int row) const { return data().viewNoteTime(at(row)); }
+		std::span<const int> viewNoteSlur(int row) const { return data().viewNoteSlur(at(row)); }
+		std::span<const float> viewOffset() const;
+		std::span<const float> viewCurve(curve_type type, int row) const { return data().viewCurve(type, at(row)); }
+		symbol langSymbol(symbol ph) const { return data().langSymbol(ph); }
+
+		std::vector<float> getCurveStep(curve_type type, int row, float step, interp_mode mode = interp_mode::linear) const {
+			return data().getCurveStep(type, at(row), step, mode);
+		}
+		std::vector<std::vector<float>> getCurveStep(curve_type type, float step, interp_mode mode = interp_mode::linear) const;
+		std::vector<std::array<std::vector<float>, curve_count>> getCurvesStep(float step, interp_mode mode = interp_mode::linear) const;
+
+	private:
+		// ȡԴ޸ǰΪݣ޸ĺΪԼĸ
+		const parser& data() const { return _own ? *_own : *_store; }
+		// кŻ㣺޸ǰֻе 0 УӦе _row޸ĺԭ
+		int at(int row) const;
+		// ״޸ʱƳһвͷŶԹݵ
+		parser& own();
+		// л滮ȣһеʱϽУıͼ
+		std::unique_ptr<parser> detached() const;
+
+		std::shared_ptr<const parser> _store;
+		size_t _row = 0;
+		std::unique_ptr<parser> _own;
+	};
+}
@@ -4,9 +4,37 @@
 namespace DS {
 	music* get_music(
 		const std::string& json, 
+		const std::string& language,
+		load_mode mode
+	){
+		return new parser(json, language, mode);
+	}
+	music* get_music_from_file(
+		const std::string& path,
+		const std::string& language,
+		load_mode mode
+	){
+		auto access = mode == load_mode::stream
+			? mapped_file::access::read_only
+			: mapped_file::access::copy_on_write;
+		return new parser(std::make_unique<mapped_file>(path, access), language, mode);
+	}
+	music* get_music_from_binary(
+		const std::string& data,
 		const std::string& language
 	){
-		return new parser(json, language);
+		return new parser(binary_reader(data.data(), data.size()), language);
+	}
+	std::string ds_to_binary(const std::string& json) {
+		// get_music ޷ıؿնתʱΪ󣬲յĶ
+		parser source(json, "", load_mode::stream);
+		if (source.parseFailed()) {
+			throw DsParserError("ȷ DS ʽ޷ JSON");
+		}
+		return source.getBinary();
+	}
+	std::string binary_to_ds(const std::string& data) {
+		return parser(binary_reader(data.data(), data.size()), "").get();
 	}
 	music* get_music(
 		const std::string& language
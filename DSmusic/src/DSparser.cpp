@@ -1,4 +1,7 @@
 #include "DSparser.h"
+#include "DStokenizer.h"
+#include "DSresample.h"
+#include "DSview.h"
 
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
@@ -8,18 +11,58 @@
 #include <sstream>
 #include <iostream>
 #include <cmath>
+#include <charconv>
+#include <thread>
+#include <algorithm>
+#include <bit>
 
 namespace DS {
-	std::vector<std::string> split_str(const std::string& str, char delimiter) {
-		std::vector<std::string> tokens;
-		std::stringstream ss(str);
-		std::string token;
+	// float תΪ double ʱʮƱʾл 0.004999999888241291 ֵ
+	double widen(float value) {
+		char buf[32];
+		auto result = std::to_chars(buf, buf + sizeof(buf), value);
+		double out = value;
+		std::from_chars(buf, result.ptr, out);
+		return out;
+	}
 
-		while (std::getline(ss, token, delimiter)) {
-			tokens.push_back(token);
+	//  parallelism ̶߳ [0, rows) ÿһе fn
+	// гȲܴ߳ÿδӹȡһУԤƽ
+	// һ׳쳣ȫ߳̽׳
+	template<typename F>
+	void parallel_rows(size_t rows, unsigned parallelism, F&& fn) {
+		const size_t workers = std::min<size_t>(parallelism, rows);
+		if (workers <= 1) {
+			for (size_t row = 0; row < rows; ++row) fn(row);
+			return;
 		}
 
-		return tokens;
+		std::atomic<size_t> next = 0;
+		std::exception_ptr error;
+		std::mutex errorMutex;
+		auto work = [&] {
+			try {
+				for (size_t row; (row = next.fetch_add(1, std::memory_order_relaxed)) < rows;) {
+					fn(row);
+				}
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(errorMutex);
+				if (!error) error = std::current_exception();
+				next.store(rows, std::memory_order_relaxed);
+			}
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve(workers - 1);
+		for (size_t i = 1; i < workers; ++i) {
+			threads.emplace_back(work);
+		}
+		work(); // ߳Ҳ
+		for (auto& thread : threads) {
+			thread.join();
+		}
+		if (error) std::rethrow_exception(error);
 	}
 
 	template<typename T>
@@ -41,241 +84,654 @@ namespace DS {
 
 	parser::parser(
 		const std::string& json,
-		const std::string& language
+		const std::string& language,
+		load_mode mode
 	)
 		: _offset(0.0f), _language(language)
 	{
+		if (mode == load_mode::stream) {
+			_parseFailed = !loadStream(json.data(), json.size());
+			return;
+		}
 		if (_dsData.Parse(json.c_str()).HasParseError()) {
+			_parseFailed = true;
 			return;
 		}
 		if (!_dsData.IsArray()) {
 			throw DsParserError("ȷ DS ʽJSON");
 		}
-		_allocator = &_dsData.GetAllocator();
 		_hasData = !_dsData.IsNull();
+		if (mode == load_mode::lazy) {
+			indexRows();
+		}
+	}
+
+	parser::parser(
+		std::unique_ptr<mapped_file> file,
+		const std::string& language,
+		load_mode mode
+	)
+		: _language(language)
+	{
+		if (binary_reader::detect(file->data(), file->size())) {
+			// пɺӳ file ͷ
+			loadBinary(binary_reader(file->data(), file->size()));
+			return;
+		}
+		if (mode == load_mode::stream) {
+			// ʽַӳ file ͷ
+			_parseFailed = !loadStream(file->data(), file->size());
+			return;
+		}
+
+		// ԭؽDOM еֱַָдʱƵӳ䣬ٿ
+		// ļǡҳСʱӳûнβ 0ֻ˻ͨ
+		bool failed = file->terminated()
+			? _dsData.ParseInsitu(file->data()).HasParseError()
+			: _dsData.Parse(file->data(), file->size()).HasParseError();
+		_file = std::move(file);
+		if (failed) {
+			_parseFailed = true;
+			return;
+		}
+		if (!_dsData.IsArray()) {
+			throw DsParserError("ȷ DS ʽJSON");
+		}
+		_hasData = true;
+		if (mode == load_mode::lazy) {
+			indexRows();
+		}
+	}
+
+	parser::parser(const binary_reader& reader, const std::string& language)
+		: _language(language)
+	{
+		loadBinary(reader);
 	}
 
 	parser::parser(const std::string& language)
 		: _offset(0.0f), _language(language)
 	{
-		_dsData.Parse("[]");
-		_allocator = &_dsData.GetAllocator();
+		_dsData.SetArray();
+	}
+
+	parser::parser(const parser& source, size_t first, size_t count)
+		: _language(source._language)
+	{
+		std::array<const void*, field_count> columns{};
+		forEachColumn(source, [&](field f, const auto& column) { columns[static_cast<size_t>(f)] = &column; });
+		forEachColumn(*this, [&](field f, auto& column) {
+			// п߲ܶʱΪգ
+			const auto& from = *static_cast<const std::decay_t<decltype(column)>*>(columns[static_cast<size_t>(f)]);
+			column.resize(count);
+			for (size_t i = 0; i < count && first + i < from.size(); ++i) {
+				column[i] = from[first + i];
+			}
+		});
+		_extraJson.resize(count);
+		_absent.resize(count);
+		for (size_t i = 0; i < count; ++i) {
+			_extraJson[i] = source.extraJson(first + i);
+			_absent[i] = source.absentFields(first + i);
+		}
+
+		// Ƽͬ DOMҪлʱɸؽ
+		_dsData.SetArray();
+		_domReady = false;
+		_hasData = true;
+		_isLoad = true;
 	}
 
 	void parser::load() {
-		if (_isLoad) {
+		load(1);
+	}
+
+	void parser::load(unsigned parallelism) {
+		if (_isLoad.load(std::memory_order_acquire)) {
 			return;
 		}
-		for (int row = 0; row < getRowCount(); row++) {
-			_phNum	.push_back(parseDS<int>("ph_num", row));
-			_noteSeq.push_back(parseDS<std::string>("note_seq", row));
-			_phSeq	.push_back(parseDS<std::string>("ph_seq", row));
-			_noteTime.push_back(parseDS<float>("note_dur", row));
-			_noteSlur.push_back(parseDS<int>("note_slur", row));
-			_offset	.push_back(parseDS<float>("offset", row).at(0));
-			_phNum[row] = makePhNum(_phSeq[row]);
-			_phTime.push_back(parseDS<float>("ph_dur", row));
+		std::lock_guard<std::mutex> lock(_loadMutex);
+		if (_isLoad.load(std::memory_order_relaxed)) {
+			return; // ڼ̼߳
+		}
+		if (parallelism == 0) {
+			parallelism = std::max(1u, std::thread::hardware_concurrency());
+		}
 
-			if (!parseDS<float>("f0_timestep", row).empty()) {
-				_f0_ticktime.push_back(parseDS<float>("f0_timestep", row).at(0));
-			}
-			_f0_seq.push_back(parseDS<float>("f0_seq", row));
+		if (_lazy.load(std::memory_order_acquire)) {
+			// ѽֶβظ
+			parallel_rows(_index.size() / field_count, parallelism, [this](size_t row) {
+				for (size_t f = 0; f < field_count; ++f) {
+					touch(row, static_cast<field>(f));
+				}
+			});
+			_isLoad.store(true, std::memory_order_release);
+			_lazy.store(false, std::memory_order_release);
+			return;
+		}
+		// ȰÿһУнʱֱдӦλ
+		// ֻдԼԪأ֮ͬ
+		const size_t rows = getRowCount();
+		resizeColumns(rows);
+		parallel_rows(rows, parallelism, [this](size_t row) { decodeRow(row); });
 
-			if (!parseDS<float>("f0_timestep", row).empty()) {
-				_energy_ticktime.push_back(parseDS<float>("energy_timestep", row).at(0));
-			}
-			_energy.push_back(parseDS<float>("energy", row));
+		_isLoad.store(true, std::memory_order_release);
+	}
 
-			if (!parseDS<float>("f0_timestep", row).empty()) {
-				_breathiness_ticktime.push_back(parseDS<float>("breathiness_timestep", row).at(0));
+	void parser::indexRows() {
+		const size_t rows = getRowCount();
+		resizeColumns(rows);
+		_index.assign(rows * field_count, nullptr);
+		_decoded = std::make_unique<std::once_flag[]>(rows * field_count);
+
+		// ֻ¼λã
+		for (size_t row = 0; row < rows; ++row) {
+			const rapidjson::Value& obj = _dsData[static_cast<rapidjson::SizeType>(row)];
+			if (!obj.IsObject()) continue;
+			uint32_t present = 0;
+			for (auto it = obj.MemberBegin(); it != obj.MemberEnd(); ++it) {
+				field f = find_field({ it->name.GetString(), it->name.GetStringLength() });
+				if (f != field::unknown) {
+					_index[row * field_count + static_cast<size_t>(f)] = &it->value;
+					present |= field_bit(f);
+				}
 			}
-			_breathiness.push_back(parseDS<float>("breathiness", row));
+			_absent[row] = ~present;
+		}
+		_lazy.store(true, std::memory_order_release);
+	}
+
+	void parser::touch(size_t row, field f) const {
+		if (!_lazy.load(std::memory_order_acquire)) return;
+		const size_t slot = row * field_count + static_cast<size_t>(f);
+		if (slot >= _index.size()) return; // Խ罻ô at() 
 
-			if (!parseDS<float>("f0_timestep", row).empty()) {
-				_voicing_ticktime.push_back(parseDS<float>("voicing_timestep", row).at(0));
+		// ֻд뱾бֶζӦԪأֶͬΡ֮ͬ以Ӱ
+		std::call_once(_decoded[slot], [this, row, f, slot] {
+			parser& self = const_cast<parser&>(*this);
+			if (_index[slot]) {
+				self.decodeField(row, f, *_index[slot]);
 			}
-			_voicing.push_back(parseDS<float>("voicing", row));
+			// ԭû ph_num ʱ ph_seq 
+			if (f == field::ph_num && self._phNum[row].empty() && _dsData[static_cast<rapidjson::SizeType>(row)].IsObject()) {
+				touch(row, field::ph_seq);
+				self.derivePhNum(row);
+			}
+		});
+	}
+
+	void parser::touchAll(field f) const {
+		if (!_lazy.load(std::memory_order_acquire)) return;
+		const size_t rows = _index.size() / field_count;
+		for (size_t row = 0; row < rows; ++row) {
+			touch(row, f);
+		}
+	}
+
+	const std::vector<float>& parser::curve(const std::vector<std::vector<float>>& column, int row) {
+		static const std::vector<float> none;
+		if (column.empty()) return none;
+		return column.at(row);
+	}
+
+	namespace {
+		// ӦֶΣ field Уʱ
+		constexpr field curve_field(curve_type type) {
+			return static_cast<field>(static_cast<size_t>(field::f0_seq) + 2 * static_cast<size_t>(type));
+		}
+
+		static_assert(curve_field(curve_type::energy) == field::energy);
+		static_assert(curve_field(curve_type::mouth_opening) == field::mouth_opening);
+		static_assert(field_count == static_cast<size_t>(curve_field(curve_type::count)));
+	}
+
+	const std::vector<std::vector<float>>& parser::curveColumn(curve_type type) const {
+		switch (type) {
+		case curve_type::f0:			return _f0_seq;
+		case curve_type::energy:		return _energy;
+		case curve_type::breathiness:	return _breathiness;
+		case curve_type::voicing:		return _voicing;
+		case curve_type::tension:		return _tension;
+		case curve_type::mouth_opening:	return _mouthOpening;
+		default: throw DsParserError("Invalid curve type");
+		}
+	}
+
+	float parser::curveTimestep(curve_type type, int row) const {
+		const std::vector<float>* ticktime = nullptr;
+		switch (type) {
+		case curve_type::f0:			ticktime = &_f0_ticktime; break;
+		case curve_type::energy:		ticktime = &_energy_ticktime; break;
+		case curve_type::breathiness:	ticktime = &_breathiness_ticktime; break;
+		case curve_type::voicing:		ticktime = &_voicing_ticktime; break;
+		case curve_type::tension:		ticktime = &_tension_ticktime; break;
+		case curve_type::mouth_opening:	ticktime = &_mouthOpening_ticktime; break;
+		default: throw DsParserError("Invalid curve type");
+		}
+		return row >= 0 && static_cast<size_t>(row) < ticktime->size() ? (*ticktime)[row] : 0.0f;
+	}
+
+	std::span<const float> parser::viewCurve(curve_type type, int row) const {
+		touch(row, curve_field(type));
+		return curve(curveColumn(type), row);
+	}
+
+	symbol parser::langSymbol(symbol ph) const {
+		if (_language.empty() || is_pause(ph)) return ph;
+		std::call_once(_langOnce, [this] {
+			_langTable = &lang_table::of(_language);
+		});
+		return _langTable->map(ph);
+	}
+
+	std::vector<float> parser::getCurveStep(curve_type type, int row, float step, interp_mode mode) const {
+		const field f = curve_field(type);
+		touch(row, f);
+		touch(row, static_cast<field>(static_cast<size_t>(f) + 1));
+		const std::vector<float>& data = curve(curveColumn(type), row);
+		const float timestep = curveTimestep(type, row);
+		if (data.empty() || step <= 0.0f)	return {};
+		if (timestep <= 0.0f)				return data;
+		return resample_curve(data, timestep, step, mode);
+	}
+
+	std::vector<std::vector<float>> parser::getCurveStep(curve_type type, float step, interp_mode mode) const {
+		const field f = curve_field(type);
+		touchAll(f);
+		touchAll(static_cast<field>(static_cast<size_t>(f) + 1));
+		std::vector<std::vector<float>> out(getRowCount());
+		for (size_t row = 0; row < out.size(); ++row) {
+			out[row] = getCurveStep(type, static_cast<int>(row), step, mode);
+		}
+		return out;
+	}
 
-			if (!parseDS<float>("f0_timestep", row).empty()) {
-				_tension_ticktime.push_back(parseDS<float>("tension_timestep", row).at(0));
+	std::vector<std::array<std::vector<float>, curve_count>> parser::getCurvesStep(float step, interp_mode mode) const {
+		std::vector<std::array<std::vector<float>, curve_count>> out(getRowCount());
+		for (size_t c = 0; c < curve_count; ++c) {
+			auto rows = getCurveStep(static_cast<curve_type>(c), step, mode);
+			for (size_t row = 0; row < out.size(); ++row) {
+				out[row][c] = std::move(rows[row]);
 			}
-			_tension.push_back(parseDS<float>("tension", row));
 		}
+		return out;
+	}
 
-		_isLoad = true;
+	void parser::resizeColumns(size_t rows) {
+		forEachColumn(*this, [rows](field, auto& column) { column.resize(rows); });
+		_absent.resize(rows);
+	}
+
+	void parser::decodeRow(size_t row) {
+		const rapidjson::Value& obj = _dsData[static_cast<rapidjson::SizeType>(row)];
+		if (!obj.IsObject()) {
+			return;
+		}
+		// ÿԱֻһΣֶڼӳ䵽Ӧ
+		uint32_t present = 0;
+		for (auto it = obj.MemberBegin(); it != obj.MemberEnd(); ++it) {
+			const field f = find_field({ it->name.GetString(), it->name.GetStringLength() });
+			if (f != field::unknown) present |= field_bit(f);
+			decodeField(row, f, it->value);
+		}
+		_absent[row] = ~present;
+		if (_phNum[row].empty()) derivePhNum(row);
 	}
 
-	void parser::pack(float maxTimeS, float maxIntervalS) {
+	void parser::decodeField(size_t row, field f, const rapidjson::Value& value) {
+		switch (f) {
+		case field::ph_seq:					parseDS(value, _phSeq[row]); break;
+		case field::ph_dur:					parseDS(value, _phTime[row]); break;
+		case field::ph_num:					parseDS(value, _phNum[row]); break;
+		case field::note_seq:				parseDS(value, _noteSeq[row]); break;
+		case field::note_dur:				parseDS(value, _noteTime[row]); break;
+		case field::note_slur:				parseDS(value, _noteSlur[row]); break;
+		case field::offset:					_offset[row] = parseScalar(value); break;
+		case field::f0_seq:					parseDS(value, _f0_seq[row]); break;
+		case field::f0_timestep:			_f0_ticktime[row] = parseScalar(value); break;
+		case field::energy:					parseDS(value, _energy[row]); break;
+		case field::energy_timestep:		_energy_ticktime[row] = parseScalar(value); break;
+		case field::breathiness:			parseDS(value, _breathiness[row]); break;
+		case field::breathiness_timestep:	_breathiness_ticktime[row] = parseScalar(value); break;
+		case field::voicing:				parseDS(value, _voicing[row]); break;
+		case field::voicing_timestep:		_voicing_ticktime[row] = parseScalar(value); break;
+		case field::tension:				parseDS(value, _tension[row]); break;
+		case field::tension_timestep:		_tension_ticktime[row] = parseScalar(value); break;
+		case field::mouth_opening:			parseDS(value, _mouthOpening[row]); break;
+		case field::mouth_opening_timestep:	_mouthOpening_ticktime[row] = parseScalar(value); break;
+		default: break; // δֶ֪α _dsData 
+		}
+	}
+
+	void parser::pack(float maxTimeS, float maxIntervalS, const pack_options& options) {
 		std::vector<std::string> temp(getRowCount());
-		pack(maxTimeS, maxIntervalS, temp);
+		pack(maxTimeS, maxIntervalS, temp, options);
 	}
 
 	std::vector<std::string> parser::pack(
 		float time_s, 
 		float maxInterval_s, 
-		const std::vector<std::string>& word_seq
+		const std::vector<std::string>& word_seq,
+		const pack_options& options
+	){
+		return pack(planPack(time_s, maxInterval_s), word_seq, options);
+	}
+
+	void parser::pack(const pack_plan& plan, const pack_options& options) {
+		std::vector<std::string> temp(getRowCount());
+		pack(plan, temp, options);
+	}
+
+	std::vector<std::string> parser::pack(
+		const pack_plan& plan,
+		const std::vector<std::string>& word_seq,
+		const pack_options& options
 	){
 		if (!_isLoad)  load(); 
+		settle();
+
+		// set ϵֻչõУȰѸв뵽
+		resizeColumns(getRowCount());
+		checkPlan(plan);
+
+		// ϲʱлأδֶ֪Ҳһ
+		parser merged(_language);
+		std::vector<std::string> new_word_seq = mergeRows(merged, plan, word_seq, options);
+		adoptColumns(merged);
+
+		return new_word_seq;
+	}
+
+	void parser::adoptColumns(parser& from) {
+		std::array<void*, field_count> columns{};
+		forEachColumn(from, [&](field f, auto& column) { columns[static_cast<size_t>(f)] = &column; });
+		forEachColumn(*this, [&](field f, auto& column) {
+			column = std::move(*static_cast<std::decay_t<decltype(column)>*>(columns[static_cast<size_t>(f)]));
+		});
+		_extraJson = std::move(from._extraJson);
+		_absent = std::move(from._absent);
+		_splitStore.reset();
+		_cache.clear();
+		// ڲ json 
+		updateJSONData();
+	}
+
+	std::unique_ptr<music> parser::packed(const pack_plan& plan, const pack_options& options) const {
+		//  write ͬгֻıڲʾı
+		if (!_isLoad.load(std::memory_order_acquire)) {
+			const_cast<parser*>(this)->load();
+		}
+		const_cast<parser*>(this)->settle();
+		const_cast<parser*>(this)->resizeColumns(getRowCount());
+		checkPlan(plan);
+
+		auto out = std::make_unique<parser>(_language);
+		mergeRows(*out, plan, {}, options);
+		out->_domReady = false;
+		out->_hasData = true;
+		out->_isLoad = true;
+		return out;
+	}
+
+	std::vector<std::string> parser::mergeRows(
+		parser& out,
+		const pack_plan& plan,
+		const std::vector<std::string>& word_seq,
+		const pack_options& options
+	) const {
+		const size_t rows = getRowCount();
 
-		// ʱ洢ϲ
-		std::vector<std::vector<std::string>> new_phSeq;
+		// ʱ洢ϲݣԭ
+		std::vector<std::vector<symbol>> new_phSeq;
 		std::vector<std::vector<float>> new_phDur;
 		std::vector<std::vector<int>> new_phNum;
 		std::vector<std::vector<int>> new_noteSlur;
 		std::vector<float> new_offset;
-		std::vector<std::vector<std::string>> new_noteSeq;
+		std::vector<std::vector<symbol>> new_noteSeq;
 		std::vector<std::vector<float>> new_noteDur;
 		std::vector<std::string> new_word_seq;
+		std::vector<std::pair<size_t, size_t>> groups;	// ÿЩԭʼкϲʼС
+		std::vector<double> rowStart(rows, 0.0);		// ÿԭʼеʼʱ䣨ʱߣ
+		new_phSeq.reserve(rows);
+		new_phDur.reserve(rows);
+		new_phNum.reserve(rows);
+		new_noteSlur.reserve(rows);
+		new_offset.reserve(rows);
+		new_noteSeq.reserve(rows);
+		new_noteDur.reserve(rows);
+		new_word_seq.reserve(rows);
+		groups.reserve(rows);
+
+		// ÿеʱֻһ
+		std::vector<float> rowTotal(rows);
+		for (size_t row = 0; row < rows; ++row) {
+			rowTotal[row] = std::accumulate(_noteTime[row].begin(), _noteTime[row].end(), 0.0f);
+		}
+		static const std::string no_word;
+		auto word = [&](size_t row) -> const std::string& { return row < word_seq.size() ? word_seq[row] : no_word; };
+
+		for (const pack_group& group : plan.groups) {
+			const size_t i = group.first;
+			const size_t end = group.first + group.count;
+			const float merged_start = _offset[i];
+
+			size_t phones = 0, notes = 0, durations = 0, letters = 0;
+			for (size_t j = i; j < end; ++j) {
+				phones += _phSeq[j].size();
+				notes += _noteSeq[j].size();
+				durations += _phTime[j].size();
+				letters += word(j).size() + 1;
+			}
+			const size_t gaps = end - i - 1;	// ÿмһֹ
 
-		size_t i = 0;
-		while (i < getRowCount()) {
-			// ʼϲ
-			std::vector<std::string> merged_phSeq;
+			std::vector<symbol> merged_phSeq, merged_noteSeq;
 			std::vector<float> merged_noteDur, merged_phDur;
-			std::vector<std::string> merged_noteSeq;
 			std::vector<int> merged_noteSlur;
 			std::string merged_wordSeq;
-
-			float merged_total_time = 0.0f;
-			float merged_start = getOffset(i);
-			size_t merge_count = 0; // ¼ϲ
-
-			// Ժϲ i ʼĶ
-			for (size_t j = i; j < getRowCount(); ++j) {
-				// ȡǰе
-				const auto& current_phSeq = _phSeq[j];
-				const auto& current_phDur = getPhDur(j);
-				const auto& current_noteDur = getNoteTime(j);
-				const auto& current_wordSeq = word_seq[j];
-				float current_start = getOffset(j);
-				float current_total = std::accumulate(current_noteDur.begin(), current_noteDur.end(), 0.0f);
-
-				// ǷǺϲ
+			merged_phSeq.reserve(phones + gaps);
+			merged_noteSeq.reserve(notes + gaps);
+			merged_noteDur.reserve(notes + gaps);
+			merged_noteSlur.reserve(notes + gaps);
+			merged_phDur.reserve(durations + gaps);
+			merged_wordSeq.reserve(letters);
+
+			// ʱߵۼʱϲۼӣÿ
+			float note_total = 0.0f;
+			float ph_total = 0.0f;
+			for (size_t j = i; j < end; ++j) {
 				if (j == i) {
-					// ֱӻȡ
-					merged_phSeq = current_phSeq;
-					merged_noteDur = current_noteDur;
-					merged_phDur = current_phDur;
-					merged_noteSeq = getNoteSeq(j);
-					merged_noteSlur = getNoteSlur(j);
-					merged_total_time = current_total;
-					merged_wordSeq = current_wordSeq;
+					note_total = rowTotal[j];
+					merged_wordSeq = word(j);
 				}
 				else {
-					// ϲ
-
 					// ʱ
-					float note_interval = current_start - (merged_start + merged_total_time) + 0.2;
+					const float note_interval = _offset[j] - (merged_start + note_total) + 0.2;
 					// ʱ
-					float ph_interval = current_start - (merged_start + std::accumulate(merged_phDur.begin(), merged_phDur.end(), 0.0f) + 0.2);
-
-					// Ƿɺϲʱ +  + ǰʱ <= maxTimeS
-					if ((merged_total_time + note_interval + current_total > time_s) ||
-						(note_interval > maxInterval_s)
-						) break; // ɺϲϲ
+					const float ph_interval = _offset[j] - (merged_start + ph_total) + 0.2;
+					const bool restEnd = !merged_phSeq.empty() && merged_phSeq.back() == symbols::SP;
 
 					//  0 һнβֹ
-					if (note_interval > 0 && merged_phSeq[merged_phSeq.size() - 1] != "SP") {
+					if (note_interval > 0 && !restEnd) {
 						// ֱӲµֹ
 						merged_noteDur.push_back(note_interval);
-						merged_noteSeq.push_back("rest");
-						merged_phSeq.push_back("SP");
+						merged_noteSeq.push_back(symbols::rest);
+						merged_phSeq.push_back(symbols::SP);
 						merged_noteSlur.push_back(0);
 						// ʱΪʱͬʱʱ
 						if (!merged_phDur.empty()) {
 							merged_phDur.push_back(ph_interval);
+							ph_total += ph_interval;
 						}
 					}
-					// һнβֹ
-					else if (merged_phSeq[merged_phSeq.size() - 1] == "SP") {
-						// ʱӵһֹ
-						merged_noteDur[merged_noteDur.size() - 1] += note_interval;
-						// ʱΪʱͬʱʱ
+					// һнβֹʱӵֹ
+					else if (restEnd) {
+						if (!merged_noteDur.empty()) merged_noteDur.back() += note_interval;
 						if (!merged_phDur.empty()) {
-							merged_phDur[merged_noteSeq.size() - 1] += ph_interval;
+							merged_phDur.back() += ph_interval;
+							ph_total += ph_interval;
 						}
 					}
 
-					// ϲǰ
-					auto row_note_dur = getNoteSeq(j);
-					auto row_note_slur = getNoteSlur(j);
-					merged_phSeq.insert(merged_phSeq.end(), current_phSeq.begin(), current_phSeq.end());
-					merged_noteDur.insert(merged_noteDur.end(), current_noteDur.begin(), current_noteDur.end());
-					merged_phDur.insert(merged_phDur.end(), current_phDur.begin(), current_phDur.end());
-					merged_noteSeq.insert(merged_noteSeq.end(), row_note_dur.begin(), row_note_dur.end());
-					merged_noteSlur.insert(merged_noteSlur.end(), row_note_slur.begin(), row_note_slur.end());
-					merged_wordSeq += " " + current_wordSeq;
-
-					merged_total_time += note_interval + current_total;
+					rowStart[j] = note_total + note_interval;
+					note_total += note_interval + rowTotal[j];
+					merged_wordSeq += ' ';
+					merged_wordSeq += word(j);
 				}
 
-				merge_count++;
+				// ϲǰ
+				merged_phSeq.insert(merged_phSeq.end(), _phSeq[j].begin(), _phSeq[j].end());
+				merged_noteDur.insert(merged_noteDur.end(), _noteTime[j].begin(), _noteTime[j].end());
+				merged_phDur.insert(merged_phDur.end(), _phTime[j].begin(), _phTime[j].end());
+				merged_noteSeq.insert(merged_noteSeq.end(), _noteSeq[j].begin(), _noteSeq[j].end());
+				merged_noteSlur.insert(merged_noteSlur.end(), _noteSlur[j].begin(), _noteSlur[j].end());
+				for (float dur : _phTime[j]) ph_total += dur;
 			}
 
-			// ɺϲ
-			if (merge_count > 0) {
-				// µ ph_num
-				std::vector<int> merged_phNum = makePhNum(merged_phSeq);
-
-				// ϲ
-				new_phSeq.push_back(merged_phSeq);
-				new_phDur.push_back(merged_phDur);
-				new_phNum.push_back(merged_phNum);
-				new_noteSlur.push_back(merged_noteSlur);
-				new_noteDur.push_back(merged_noteDur);
-				new_offset.push_back(merged_start);
-				new_noteSeq.push_back(merged_noteSeq);
-				new_word_seq.push_back(merged_wordSeq);
-
-				// Ѻϲ
-				i += merge_count;
+			// ϲУph_num ϲ»֣еıԭ ph_num
+			new_phNum.push_back(end - i == 1 ? _phNum[i] : makePhNum(merged_phSeq));
+			new_phSeq.push_back(std::move(merged_phSeq));
+			new_phDur.push_back(std::move(merged_phDur));
+			new_noteSlur.push_back(std::move(merged_noteSlur));
+			new_noteDur.push_back(std::move(merged_noteDur));
+			new_offset.push_back(merged_start);
+			new_noteSeq.push_back(std::move(merged_noteSeq));
+			new_word_seq.push_back(std::move(merged_wordSeq));
+			groups.emplace_back(i, end - i);
+		}
+		// ߰еλ֡ƴӣʱȡϲĸС
+		// ڱнĲʱ䣬ʱʱһ𻻳
+		std::array<void*, field_count> targets{};
+		forEachColumn(out, [&](field f, auto& column) { targets[static_cast<size_t>(f)] = &column; });
+		const std::vector<std::vector<float>>* curves = nullptr;
+		std::vector<curve_piece> pieces;
+		forEachColumn(*this, [&](field f, const auto& column) {
+			using column_t = std::decay_t<decltype(column)>;
+			if (f < field::f0_seq) return;
+			if constexpr (std::is_same_v<column_t, std::vector<std::vector<float>>>) {
+				curves = &column;
 			}
-			else {
-				// ޷ϲǰ
-				new_phSeq.push_back(getPhSeq(i));
-				new_phDur.push_back(getPhDur(i));
-				new_phNum.push_back(getPhNum(i));
-				new_noteSlur.push_back(getNoteSlur(i));
-				new_noteDur.push_back(getNoteTime(i));
-				new_offset.push_back(getOffset(i));
-				new_noteSeq.push_back(getNoteSeq(i));
-				new_word_seq.push_back(merged_wordSeq);
-
-				i++;
-			}
-		}
-		// ڲ
-		_phSeq = std::move(new_phSeq);
-		_phTime = std::move(new_phDur);
-		_phNum = std::move(new_phNum);
-		_noteSlur = std::move(new_noteSlur);
-		_noteTime = std::move(new_noteDur);
-		_offset = std::move(new_offset);
-		_noteSeq = std::move(new_noteSeq);
-		// ڲ json 
-		updateJSONData();
+			else if constexpr (std::is_same_v<column_t, std::vector<float>>) {
+				// п߲ܶʱΪգΪû
+				const size_t stored = std::min(curves->size(), column.size());
+				std::vector<std::vector<float>> mergedCurves(groups.size());
+				std::vector<float> mergedSteps(groups.size(), 0.0f);
+				for (size_t g = 0; g < groups.size(); ++g) {
+					const auto [first, count] = groups[g];
+					if (count == 1) {
+						if (first < stored) {
+							mergedCurves[g] = (*curves)[first];
+							mergedSteps[g] = column[first];
+						}
+						continue;
+					}
+					float step = 0.0f;
+					pieces.clear();
+					for (size_t j = first; j < first + count; ++j) {
+						const float timestep = j < stored ? column[j] : 0.0f;
+						const bool present = timestep > 0.0f && !(*curves)[j].empty();
+						if (present && (step == 0.0f || timestep < step)) step = timestep;
+						pieces.push_back({ present ? std::span<const float>((*curves)[j]) : std::span<const float>(), timestep, rowStart[j] });
+					}
+					if (step == 0.0f) continue;
+					double end = 0.0;
+					for (float dur : new_noteDur[g]) end += dur;
+					mergedCurves[g] = splice_curves(pieces, step, end, options);
+					mergedSteps[g] = step;
+				}
+				*static_cast<std::vector<std::vector<float>>*>(targets[static_cast<size_t>(f) - 1]) = std::move(mergedCurves);
+				*static_cast<std::vector<float>*>(targets[static_cast<size_t>(f)]) = std::move(mergedSteps);
+			}
+		});
+
+		// δֶ֪޷ϲֻе
+		// ϲУԭĶûеֶȻoffset ģ
+		std::vector<std::string> new_extra(groups.size());
+		std::vector<uint32_t> new_absent(groups.size(), ~uint32_t(0));
+		for (size_t g = 0; g < groups.size(); ++g) {
+			if (groups[g].second == 1) new_extra[g] = extraJson(groups[g].first);
+			for (size_t j = groups[g].first; j < groups[g].first + groups[g].second; ++j) {
+				new_absent[g] &= absentFields(j);
+			}
+			if (groups[g].second > 1) new_absent[g] &= ~field_bit(field::offset);
+		}
+
+		out._phSeq = std::move(new_phSeq);
+		out._phTime = std::move(new_phDur);
+		out._phNum = std::move(new_phNum);
+		out._noteSlur = std::move(new_noteSlur);
+		out._noteTime = std::move(new_noteDur);
+		out._offset = std::move(new_offset);
+		out._noteSeq = std::move(new_noteSeq);
+		out._extraJson = std::move(new_extra);
+		out._absent = std::move(new_absent);
 
 		return new_word_seq;
 	}
 
+	void parser::scatter(
+		const pack_plan& plan,
+		curve_type type,
+		const std::vector<std::vector<float>>& outputs,
+		float step
+	){
+		if (!(step > 0.0f)) {
+			throw DsParserError("ߵ֡ 0");
+		}
+		if (!_isLoad)  load();
+		settle();
+		resizeColumns(getRowCount());
+		checkPlan(plan);
+
+		// ԭʼڴеλðǰ¼㣬 plan.rows Ƿд
+		pack_plan placed = plan;
+		placeRows(placed, packRows());
+
+		const field f = curve_field(type);
+		std::vector<std::vector<float>>* curves = nullptr;
+		std::vector<float>* steps = nullptr;
+		forEachColumn(*this, [&](field g, auto& column) {
+			if constexpr (std::is_same_v<std::decay_t<decltype(column)>, std::vector<std::vector<float>>>) {
+				if (g == f) curves = &column;
+			}
+			else if constexpr (std::is_same_v<std::decay_t<decltype(column)>, std::vector<float>>) {
+				if (static_cast<size_t>(g) == static_cast<size_t>(f) + 1) steps = &column;
+			}
+		});
+
+		for (size_t row = 0; row < placed.rows.size(); ++row) {
+			const pack_row& r = placed.rows[row];
+			if (r.group >= outputs.size() || outputs[r.group].empty()) continue;
+			const std::vector<float>& source = outputs[r.group];
+			// ȡиǵ֡ģڴʱһ֡
+			const size_t first = r.first_frame(step);
+			const size_t end = r.end_frame(step);
+			std::vector<float> data(end - first, source.back());
+			if (first < source.size()) {
+				std::copy(source.begin() + first, source.begin() + std::min(end, source.size()), data.begin());
+			}
+			(*curves)[row] = std::move(data);	markDirty(row, f);
+			(*steps)[row] = step;				markDirty(row, static_cast<field>(static_cast<size_t>(f) + 1));
+			if (type == curve_type::f0) _cache.invalidate(row, feature_bit(feature::pitch_step));
+		}
+	}
+
 	std::vector<std::unique_ptr<music>> parser::split() {
 		load();
+		const size_t rows = getRowCount();
+		resizeColumns(rows);
+
+		// ͬһֻϵͼлٽͼ޸ʱŸƳԼһ
+		// δ޸ϴ split ʹʱֱӸǷݸ
+		std::shared_ptr<const parser> store = _splitStore.lock();
+		if (!store) {
+			store = std::make_shared<const parser>(*this, 0, rows);
+			_splitStore = store;
+		}
 		std::vector<std::unique_ptr<music>> out;
-
-		const auto& rows_data = _dsData.GetArray();
-		for (const auto& element : rows_data) {
-			rapidjson::StringBuffer buffer;
-			rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-			element.Accept(writer);
-
-			if (buffer.GetSize() == 0) {
-				continue; // лʧܴ
-			}
-
-			std::string row_ds = "[" + std::string(buffer.GetString()) + "]";
-			out.emplace_back(get_music(row_ds, _language));
+		out.reserve(rows);
+		for (size_t row = 0; row < rows; ++row) {
+			out.push_back(std::make_unique<row_view>(store, row));
 		}
-
 		return out;
 	}
 
@@ -289,6 +745,7 @@ namespace DS {
 		float offset,
 		int row
 	) {
+		settle();
 		// ȼǷϷ
 		if (note_seq.empty())	throw DsParserError("Ϊ");
 		if (note_dur.empty())	throw DsParserError("ʱΪ");
@@ -300,6 +757,10 @@ namespace DS {
 		if (note_seq.size() != note_dur.size()) throw DsParserError("ʱδ");
 		if (note_seq.size() != note_slur.size()) throw DsParserError("־δ");
 
+		// ȵǼǣűʱ޸κ֮ǰ׳󱣳ԭ״
+		std::vector<symbol> notes = intern_symbols(note_seq);
+		std::vector<symbol> phonemes = intern_symbols(ph_seq);
+
 		// Ȼ󱣴
 		if (row >= _noteSeq.size())	_noteSeq.insert(_noteSeq.end(), row - _noteSeq.size() + 1, {});
 		if (row >= _noteTime.size())	_noteTime.insert(_noteTime.end(), row - _noteTime.size() + 1, {});
@@ -309,13 +770,14 @@ namespace DS {
 		if (row >= _phNum.size())	_phNum.insert(_phNum.end(), row - _phNum.size() + 1, {});
 		if (row >= _offset.size())	_offset.insert(_offset.end(), row - _offset.size() + 1, 0.0f);
 
-		_noteSeq[row] = note_seq;		saveString("note_seq", note_seq, row);
-		_noteTime[row] = note_dur;		saveString("note_dur", note_dur, row);
-		_noteSlur[row] = note_slur;		saveString("note_slur", note_slur, row);
-		_phSeq[row] = ph_seq;			saveString("ph_seq", ph_seq, row);
-		_phTime[row] = ph_dur;			saveString("ph_dur", ph_dur, row);
-		_phNum[row] = makePhNum(ph_seq);saveString("ph_num", ph_seq, row);
-		_offset[row] = offset;			saveNumber("offset", offset, row);
+		_noteSeq[row] = std::move(notes);			markDirty(row, field::note_seq);
+		_noteTime[row] = note_dur;					markDirty(row, field::note_dur);
+		_noteSlur[row] = note_slur;					markDirty(row, field::note_slur);
+		_phSeq[row] = std::move(phonemes);			markDirty(row, field::ph_seq);
+		_phTime[row] = ph_dur;						markDirty(row, field::ph_dur);
+		_phNum[row] = makePhNum(_phSeq[row]);		markDirty(row, field::ph_num);
+		_offset[row] = offset;						markDirty(row, field::offset);
+		_cache.invalidate(row, features_all);
 
 		_hasData = true;
 		_isLoad = true;
@@ -331,12 +793,16 @@ namespace DS {
 		float offset, 
 		int row
 	){
+		settle();
 		// ȼǷϷ
 		if (note_seq.empty())	throw DsParserError("Ϊ");
 		if (note_dur.empty())	throw DsParserError("ʱΪ");
 		if (note_slur.empty())	throw DsParserError("־Ϊ");
 		if (offset < 0)			throw DsParserError("ʼʱС 0");
 
+		// űʱ޸κ֮ǰ׳
+		std::vector<symbol> notes = intern_symbols(note_seq);
+
 		// Ȼ󱣴
 		if (row >= _noteSeq.size())	_noteSeq.insert(_noteSeq.end(), row - _noteSeq.size() + 1, {});
 		if (row >= _noteTime.size())	_noteTime.insert(_noteTime.end(), row - _noteTime.size() + 1, {});
@@ -345,12 +811,13 @@ namespace DS {
 		if (row >= _phTime.size())	_phTime.insert(_phTime.end(), row - _phTime.size() + 1, {});
 		if (row >= _offset.size())	_offset.insert(_offset.end(), row - _offset.size() + 1, 0.0f);
 
-		_noteSeq[row] = note_seq;		saveString("note_seq", note_seq, row);
-		_noteTime[row] = note_dur;		saveString("note_dur", note_dur, row);
-		_noteSlur[row] = note_slur;		saveString("note_slur", note_slur, row);
-		_phSeq[row] = std::vector<std::string>(note_seq.size(), "SP");
-		_phTime[row] = note_dur;		saveString("ph_dur", note_dur, row);
-		_offset[row] = offset;			saveNumber("offset", offset, row);
+		_noteSeq[row] = std::move(notes);	markDirty(row, field::note_seq);
+		_noteTime[row] = note_dur;		markDirty(row, field::note_dur);
+		_noteSlur[row] = note_slur;		markDirty(row, field::note_slur);
+		_phSeq[row] = std::vector<symbol>(note_seq.size(), symbols::SP);
+		_phTime[row] = note_dur;		markDirty(row, field::ph_dur);
+		_offset[row] = offset;			markDirty(row, field::offset);
+		_cache.invalidate(row, features_all);
 
 		// ʱЧ DS
 		_readyCase = true;
@@ -359,20 +826,25 @@ namespace DS {
 	}
 
 	bool parser::set_lyrics(const std::vector<std::string>& ph_seq, const std::vector<float>& ph_dur, int row){
+		settle();
 		if(!_readyCase)			throw DsParserError("ûдʸ");
 
 		// ȼǷϷ
 		if (ph_seq.empty())		throw DsParserError("Ϊ");
 		if (ph_dur.empty())		throw DsParserError("ʱΪ");
 
+		// űʱ޸κ֮ǰ׳
+		std::vector<symbol> phonemes = intern_symbols(ph_seq);
+
 		// Ȼ󱣴
 		if (row >= _phSeq.size())	_phSeq.insert(_phSeq.end(), row - _phSeq.size() + 1, {});
 		if (row >= _phTime.size())	_phTime.insert(_phTime.end(), row - _phTime.size() + 1, {});
 		if (row >= _phNum.size())	_phNum.insert(_phNum.end(), row - _phNum.size() + 1, {});
 
-		_phSeq[row] = ph_seq;			saveString("ph_seq", ph_seq, row);
-		_phTime[row] = ph_dur;			saveString("ph_dur", ph_dur, row);
-		_phNum[row] = makePhNum(ph_seq);saveString("ph_num", ph_seq, row);
+		_phSeq[row] = std::move(phonemes);	markDirty(row, field::ph_seq);
+		_phTime[row] = ph_dur;					markDirty(row, field::ph_dur);
+		_phNum[row] = makePhNum(_phSeq[row]);	markDirty(row, field::ph_num);
+		_cache.invalidate(row, feature_bit(feature::midi_ph));
 
 		_hasData = true;
 		_isLoad = true;
@@ -390,177 +862,167 @@ namespace DS {
 	std::string parser::get()const {
 		rapidjson::StringBuffer buffer;
 		rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-		_dsData.Accept(writer);
+		dom().Accept(writer);
 		return buffer.GetString();
 	}
 
 	int parser::getRowCount() const {
-		return _dsData.GetArray().Size();
+		if (!_domReady) {
+			return static_cast<int>(_offset.size());
+		}
+		return _dsData.IsArray() ? _dsData.Size() : 0;
 	}
 
 	std::vector<std::string> parser::getPhSeq(int row) const{
+		touch(row, field::ph_seq);
 		if (_language.empty()) {
-			return _phSeq[row];
+			return symbol_names(_phSeq[row]);
 		}
 		std::vector<std::string> out(_phSeq[row].size());
 		for (int i = 0;i < _phSeq[row].size();i++) {
-			if (_phSeq[row][i] != "SP" && _phSeq[row][i] != "AP") {
-				out[i] = getLang() + "/" + _phSeq[row][i];
-			}
-			else {
-				out[i] = _phSeq[row][i];
-			}
+			out[i] = symbol_name(langSymbol(_phSeq[row][i]));
 		}
 		return out;
 	}
 
 	std::vector<std::string> parser::getPhSeq_raw(int row) const{
-		return _phSeq[row];
+		touch(row, field::ph_seq);
+		return symbol_names(_phSeq[row]);
 	}
 
-	std::vector<float> parser::getNoteDur(int row, float step) const{
-		if (_noteTime.empty() || _noteTime.at(row).empty()) return {};
-		std::vector<float> out;
-		for (auto& time : _noteTime.at(row)) {
-			out.push_back(time / step);
-		}
-		return out;
+	const std::vector<float>& parser::getNoteDur(int row, float step) const{
+		return _cache.get(row, feature::note_dur, step, [&]() -> std::vector<float> {
+			touch(row, field::note_dur);
+			if (_noteTime.empty() || _noteTime.at(row).empty()) return {};
+			std::vector<float> out;
+			for (auto& time : _noteTime.at(row)) {
+				out.push_back(time / step);
+			}
+			return out;
+		});
 	}
 
 	parser& parser::setPitch(std::vector<float> data, float offset, int row) {
+		settle();
 		if (row >= _f0_seq.size())	_f0_seq.insert(_f0_seq.end(), row - _f0_seq.size() + 1, {});
-		if (row >= _offset.size())	_offset.insert(_offset.end(), row - _noteSeq.size() + 1, 0);
-		_f0_seq[row] = data;
-		_offset[row] = offset;
-		saveString("f0_seq", data, row);
+		if (row >= _offset.size())	_offset.insert(_offset.end(), row - _offset.size() + 1, 0);
+		_f0_seq[row] = std::move(data);		markDirty(row, field::f0_seq);
+		_offset[row] = offset;				markDirty(row, field::offset);
+		_cache.invalidate(row, feature_bit(feature::pitch_step));
 		return *this;
 	}
 
 	const std::vector<float> parser::getPitch(int row) const { 
+		touch(row, field::f0_seq);
 		return _f0_seq.at(row); 
 	}
 
-	const std::vector<float> parser::getPitchStep(int row, float step) const{
-		if ((_f0_seq.empty() || _f0_seq.at(row).empty()) && !_noteSeq.at(row).empty()) {
-			return  P_F_conversion(resampling(_noteSeq.at(row), _noteTime.at(row), step));
-		}
-		else return _f0_seq.at(row);
-	}
-
-	const std::vector<float> parser::getMidi(int row) const{
-		if (!_noteSeq.at(row).empty()) {
-			return P_M_conversion(_noteSeq.at(row));
-		}
-		else return {};
-	}
-
-	const std::vector<float> parser::getMidiPh(int row) const{
-		if (_noteSeq.at(row).empty()) return {};
-		std::vector<std::string> note_ph;
-		for (int index = 0;index < _phNum.at(row).size();++index) {
-			for (int i = 0;i < _phNum.at(row)[index];++i) {
-				note_ph.push_back(_noteSeq.at(row)[index]);
+	const std::vector<float>& parser::getPitchStep(int row, float step) const{
+		return _cache.get(row, feature::pitch_step, step, [&]() -> std::vector<float> {
+			touch(row, field::f0_seq);
+			touch(row, field::note_seq);
+			touch(row, field::note_dur);
+			if ((_f0_seq.empty() || _f0_seq.at(row).empty()) && !_noteSeq.at(row).empty()) {
+				return  P_F_conversion(resampling(_noteSeq.at(row), _noteTime.at(row), step));
 			}
-		}
-		return P_M_conversion(note_ph);
-	}
-
-	const std::vector<float> parser::getPitch(int row) const { 
-		return _f0_seq.at(row); 
-	}
-
-	const std::vector<float> parser::getPitchStep(int row, float step) const{
-		if ((_f0_seq.empty() || _f0_seq.at(row).empty()) && !_noteSeq.at(row).empty()) {
-			return  P_F_conversion(resampling(_noteSeq.at(row), _noteTime.at(row), step));
-		}
-		else return _f0_seq.at(row);
+			else return getCurveStep(curve_type::f0, row, step, interp_mode::linear);
+		});
 	}
 
 	const std::vector<float> parser::getMidi(int row) const{
+		touch(row, field::note_seq);
 		if (!_noteSeq.at(row).empty()) {
 			return P_M_conversion(_noteSeq.at(row));
 		}
 		else return {};
 	}
 
-	const std::vector<float> parser::getMidiPh(int row) const{
-		if (_noteSeq.at(row).empty()) return {};
-		std::vector<std::string> note_ph;
-		for (int index = 0;index < _phNum.at(row).size();++index) {
-			for (int i = 0;i < _phNum.at(row)[index];++i) {
-				note_ph.push_back(_noteSeq.at(row)[index]);
+	const std::vector<float>& parser::getMidiPh(int row) const{
+		return _cache.get(row, feature::midi_ph, 0.0f, [&]() -> std::vector<float> {
+			touch(row, field::note_seq);
+			touch(row, field::ph_num);
+			if (_noteSeq.at(row).empty()) return {};
+			std::vector<symbol> note_ph;
+			for (int index = 0;index < _phNum.at(row).size();++index) {
+				for (int i = 0;i < _phNum.at(row)[index];++i) {
+					note_ph.push_back(_noteSeq.at(row)[index]);
+				}
 			}
-		}
-		return P_M_conversion(note_ph);
+			return P_M_conversion(note_ph);
+		});
 	}
 
-	const std::vector<float> parser::getMidiStep(int row, float step) const{
-		if (!_noteSeq.at(row).empty()) {
-			return  P_M_conversion(resampling(_noteSeq.at(row), _noteTime.at(row), step));
-		}
-		else return {};
+	const std::vector<float>& parser::getMidiStep(int row, float step) const{
+		return _cache.get(row, feature::midi_step, step, [&]() -> std::vector<float> {
+			touch(row, field::note_seq);
+			touch(row, field::note_dur);
+			if (!_noteSeq.at(row).empty()) {
+				return  P_M_conversion(resampling(_noteSeq.at(row), _noteTime.at(row), step));
+			}
+			else return {};
+		});
 	}
 
 	parser& parser::setPhTime(std::vector<float> data, float offset, int row) {
+		settle();
 		if (row >= _phTime.size())	_phTime.insert(_phTime.end(), row - _phTime.size() + 1, {});
-		if (row >= _offset.size())	_offset.insert(_offset.end(), row - _noteSeq.size() + 1, 0);
-		_phTime[row] = data;
-		_offset[row] = offset;
-		saveString("ph_dur", data, row);
+		if (row >= _offset.size())	_offset.insert(_offset.end(), row - _offset.size() + 1, 0);
+		_phTime[row] = std::move(data);		markDirty(row, field::ph_dur);
+		_offset[row] = offset;				markDirty(row, field::offset);
 		return *this;
 	}
 
 	parser& parser::setEnergy(std::vector<float> data, float offset, int row) {
+		settle();
 		if (row >= _energy.size())	_energy.insert(_energy.end(), row - _energy.size() + 1, {});
-		if (row >= _offset.size())	_offset.insert(_offset.end(), row - _noteSeq.size() + 1, 0);
-		_energy[row] = data;
-		_offset[row] = offset;
-		saveString("energy", data, row);
+		if (row >= _offset.size())	_offset.insert(_offset.end(), row - _offset.size() + 1, 0);
+		_energy[row] = std::move(data);		markDirty(row, field::energy);
+		_offset[row] = offset;				markDirty(row, field::offset);
 		return *this;
 	}
 
 	parser& parser::setBreathiness(std::vector<float> data, float offset, int row) {
+		settle();
 		if (row >= _breathiness.size())	_breathiness.insert(_breathiness.end(), row - _breathiness.size() + 1, {});
-		if (row >= _offset.size())	_offset.insert(_offset.end(), row - _noteSeq.size() + 1, 0);
-		_breathiness[row] = data;
-		_offset[row] = offset;
-		saveString("breathiness", data, row);
+		if (row >= _offset.size())	_offset.insert(_offset.end(), row - _offset.size() + 1, 0);
+		_breathiness[row] = std::move(data);		markDirty(row, field::breathiness);
+		_offset[row] = offset;				markDirty(row, field::offset);
 		return *this;
 	}
 
 	parser& parser::setVoicing(std::vector<float> data, float offset, int row) {
+		settle();
 		if (row >= _voicing.size())	_voicing.insert(_voicing.end(), row - _voicing.size() + 1, {});
-		if (row >= _offset.size())	_offset.insert(_offset.end(), row - _noteSeq.size() + 1, 0);
-		_voicing[row] = data;
-		_offset[row] = offset;
-		saveString("voicing", data, row);
+		if (row >= _offset.size())	_offset.insert(_offset.end(), row - _offset.size() + 1, 0);
+		_voicing[row] = std::move(data);		markDirty(row, field::voicing);
+		_offset[row] = offset;				markDirty(row, field::offset);
 		return *this;
 	}
 
 	parser& parser::setTension(std::vector<float> data, float offset, int row) {
+		settle();
 		if (row >= _tension.size())	_tension.insert(_tension.end(), row - _tension.size() + 1, {});
-		if (row >= _offset.size())	_offset.insert(_offset.end(), row - _noteSeq.size() + 1, 0);
-		_tension[row] = data;
-		_offset[row] = offset;
-		saveString("tension", data, row);
+		if (row >= _offset.size())	_offset.insert(_offset.end(), row - _offset.size() + 1, 0);
+		_tension[row] = std::move(data);		markDirty(row, field::tension);
+		_offset[row] = offset;				markDirty(row, field::offset);
 		return *this;
 	}
 
 	parser& parser::setMouthOpening(std::vector<float> data, float offset, int row){
+		settle();
 		if (row >= _mouthOpening.size())	_mouthOpening.insert(_mouthOpening.end(), row - _mouthOpening.size() + 1, {});
-		if (row >= _offset.size())	_offset.insert(_offset.end(), row - _noteSeq.size() + 1, 0);
-		_mouthOpening[row] = data;
-		_offset[row] = offset;
-		saveString("mouth_opening", data, row);
+		if (row >= _offset.size())	_offset.insert(_offset.end(), row - _offset.size() + 1, 0);
+		_mouthOpening[row] = std::move(data);		markDirty(row, field::mouth_opening);
+		_offset[row] = offset;				markDirty(row, field::offset);
 		return *this;
 	}
 
-	std::vector<std::string> parser::makePhSeq(
-		const std::vector<std::string>& ph_seq,
+	std::vector<symbol> parser::makePhSeq(
+		const std::vector<symbol>& ph_seq,
 		const std::vector<int>& note_slur
 	) {
 		auto ph_num = makePhNum(ph_seq);
-		std::vector<std::string> out;
+		std::vector<symbol> out;
 		for (int i = 0, j = 0, k = 0; i < note_slur.size(); ++i) {
 			if (note_slur[i] == 1) {
 				// ظһΨһ
@@ -577,16 +1039,13 @@ namespace DS {
 		return out;
 	}
 
-	std::vector<int> parser::makePhNum(const std::vector<std::string>& ph_seq) {
+	std::vector<int> parser::makePhNum(const std::vector<symbol>& ph_seq) const {
 		std::vector<int> ph_num;
 		int num = 1;
 		// ÿһ
 		for (size_t i = 1; i < ph_seq.size(); ++i) {
-			// ȡ
-			const std::string& ph = ph_seq[i];
-
-			// жǷΪԪʹô ph
-			if (is_vowel(ph)) {
+			// Ԫ־ڵǼǷʱѾ
+			if (is_vowel(ph_seq[i])) {
 				ph_num.push_back(num);
 				num = 0; // ü
 			}
@@ -600,6 +1059,11 @@ namespace DS {
 		return ph_num;
 	}
 
+	void parser::derivePhNum(size_t row) {
+		_phNum[row] = makePhNum(_phSeq[row]);
+		_absent[row] |= field_bit(field::ph_num);
+	}
+
 	std::vector<int> parser::makePhNum(const std::vector<int>& ph_num, const std::vector<int>& note_sulr) {
 		std::vector<int> new_ph_num = ph_num;
 		for (int i = 0;i < note_sulr.size();i++) {
@@ -615,105 +1079,171 @@ namespace DS {
 	}
 
 	template<typename T>
-	std::vector<T> parser::parseDS(const std::string& key, size_t index) {
-		// ȡָĶ
-		if (index >= _dsData.Size() || !_dsData[index].IsObject()) {
-			return {};
+	void parser::parseDS(const rapidjson::Value& value, std::vector<T>& out) {
+		out.clear();
+		if (value.IsNumber()) {
+			// ֱȡֵپ to_string ⾫ʧ
+			if constexpr (std::is_arithmetic_v<T>) {
+				out.push_back(static_cast<T>(value.GetDouble()));
+			}
+			else if constexpr (std::is_same_v<T, symbol>) {
+				out.push_back(intern_symbol(std::to_string(value.GetDouble())));
+			}
+			else {
+				out.push_back(std::to_string(value.GetDouble()));
+			}
 		}
-		const rapidjson::Value& obj = _dsData[index];
-		// ָļ
-		if (!obj.HasMember(key.c_str())) {
-			return {};
+		else if (value.IsString()) {
+			// ֱ rapidjson ַϷִ
+			const char* str = value.GetString();
+			tokenize(str, str + value.GetStringLength(), out);
 		}
-		const rapidjson::Value& value = obj[key.c_str()];
+	}
 
-		// ֵͣתΪַ
-		std::string valueStr;
+	float parser::parseScalar(const rapidjson::Value& value) {
 		if (value.IsNumber()) {
-			valueStr = std::to_string(value.GetDouble());  // ʹ GetDouble() 򸡵
+			return static_cast<float>(value.GetDouble());
 		}
-		else if (value.IsString()) {
-			valueStr = value.GetString();  // Ѿֱַͣʹ
+		std::vector<float> parsed;
+		parseDS(value, parsed);
+		return parsed.empty() ? 0.0f : parsed.front();
+	}
+
+	template<typename T>
+	void appendVector(std::string& out, const std::vector<T>& vec);
+
+	void parser::markDirty(size_t row, field f) {
+		_splitStore.reset();
+		if (row < _absent.size()) _absent[row] &= ~field_bit(f);
+		// δ DOM ʱоݣʱһд룻ԭľֵҪ
+		if (!_domReady) {
+			dropExtra(row, f);
+			return;
 		}
-		else {
-			return {};  // ȲҲַؿս
+		//  _dsData Ϊ׼ȷһնռλ
+		if (!_dsData.IsArray()) _dsData.SetArray();
+		while (_dsData.Size() <= row) {
+			_dsData.PushBack(rapidjson::Value(rapidjson::kObjectType), _dsData.GetAllocator());
 		}
+		if (_dirty.size() <= row) _dirty.resize(row + 1, 0);
+		_dirty[row] |= uint32_t(1) << static_cast<size_t>(f);
+		_anyDirty = true;
+	}
 
-		// ֵոַָ
-		std::vector<std::string> splitValues = DS::split_str(valueStr, ' ');
-
-		// ַָתΪĿͲ
-		std::vector<T> result;
-		for (const auto& item : splitValues) {
-			std::istringstream iss(item);
-			T convertedValue;
-			iss >> convertedValue;
-			if (iss.fail()) {
-				continue; // ֻɱȷ͵
+	void parser::flushDirty() const {
+		static_assert(field_count <= 32, "_dirty holds one bit per field");
+		for (size_t row = 0; row < _dirty.size(); ++row) {
+			for (uint32_t bits = _dirty[row]; bits != 0; bits &= bits - 1) {
+				const field f = static_cast<field>(std::countr_zero(bits));
+				switch (f) {
+				case field::ph_seq:					saveString(f, _phSeq[row], row); break;
+				case field::ph_dur:					saveString(f, _phTime[row], row); break;
+				case field::ph_num:					saveString(f, _phNum[row], row); break;
+				case field::note_seq:				saveString(f, _noteSeq[row], row); break;
+				case field::note_dur:				saveString(f, _noteTime[row], row); break;
+				case field::note_slur:				saveString(f, _noteSlur[row], row); break;
+				case field::offset:					saveNumber(f, _offset[row], row); break;
+				case field::f0_seq:					saveString(f, _f0_seq[row], row); break;
+				case field::f0_timestep:			saveNumber(f, _f0_ticktime[row], row); break;
+				case field::energy:					saveString(f, _energy[row], row); break;
+				case field::energy_timestep:		saveNumber(f, _energy_ticktime[row], row); break;
+				case field::breathiness:			saveString(f, _breathiness[row], row); break;
+				case field::breathiness_timestep:	saveNumber(f, _breathiness_ticktime[row], row); break;
+				case field::voicing:				saveString(f, _voicing[row], row); break;
+				case field::voicing_timestep:		saveNumber(f, _voicing_ticktime[row], row); break;
+				case field::tension:				saveString(f, _tension[row], row); break;
+				case field::tension_timestep:		saveNumber(f, _tension_ticktime[row], row); break;
+				case field::mouth_opening:			saveString(f, _mouthOpening[row], row); break;
+				case field::mouth_opening_timestep:	saveNumber(f, _mouthOpening_ticktime[row], row); break;
+				default: break;
+				}
 			}
-			result.push_back(convertedValue);
 		}
-		return result;
+		_dirty.clear();
+
+		// ֵռڴصһʱʱ䷴޸ʱڴ治
+		if (_garbage > compact_threshold && _garbage * 2 > _dsData.GetAllocator().Size()) {
+			compact();
+		}
+		// ɺ߳̿û޸ʱֱӶȡ _dsData
+		_anyDirty = false;
 	}
 
-	template<typename T>
-	parser& parser::saveNumber(const std::string& key, const T& value, size_t index) {
-		rapidjson::Value& arr = _dsData.GetArray();
-		rapidjson::Value& obj = arr[index];
+	void parser::setMember(size_t row, field f, rapidjson::Value& value, const char* owned) const {
+		rapidjson::Value& obj = _dsData[static_cast<rapidjson::SizeType>(row)];
+		// ԭвǶУ޸ĺΪ
+		if (!obj.IsObject()) obj.SetObject();
+		const std::string_view key = field_key(f);
+		const rapidjson::Value::StringRefType name(key.data(), static_cast<rapidjson::SizeType>(key.size()));
+		auto it = obj.FindMember(name);
+		if (it == obj.MemberEnd()) {
+			// ֶǳֱãռڴ
+			obj.AddMember(name, value, _dsData.GetAllocator());
+			return;
+		}
+
+		// ֵڴеַͳ޷ͷŵ
+		// ָԭؽӳ _fieldText ַڴ
+		const rapidjson::Value& old = it->value;
+		if (old.IsString()) {
+			const char* text = old.GetString();
+			const bool mapped = _file && text >= _file->data() && text < _file->data() + _file->size();
+			if (!mapped && text != owned) _garbage += old.GetStringLength() + 1;
+		}
+		it->value = value;
+	}
 
-		rapidjson::Value json_key(key.c_str(), *_allocator);
+	void parser::resetDom() const {
+		rapidjson::Document fresh;
+		fresh.SetArray();
+		_dsData.Swap(fresh);
+		_fieldText.clear();
+		_garbage = 0;
+	}
 
-		if constexpr (std::is_arithmetic_v<T>) {
+	void parser::compact() const {
+		// ӳ _fieldText ַֻãֵµڴ
+		rapidjson::Document fresh;
+		fresh.CopyFrom(_dsData, fresh.GetAllocator());
+		_dsData.Swap(fresh);
+		_garbage = 0;
+	}
+
+	template<typename T>
+	void parser::saveNumber(field f, const T& value, size_t index) const {
+		rapidjson::Value json_val;
+		if constexpr (std::is_same_v<T, float>) {
+			//  buildDom һ£̱ʾչΪ doubleд 0.10000000149011612
+			json_val.SetDouble(widen(value));
+		}
+		else if constexpr (std::is_arithmetic_v<T>) {
 			// 洢Ϊ
-			rapidjson::Value json_val(value);
-			obj.AddMember(json_key, json_val, *_allocator);
+			json_val = rapidjson::Value(value);
 		}
 		else {
 			// Ƿ
-			static_assert(false, "Cannot store non-numeric value as a number.");
+			static_assert(sizeof(T) == 0, "Cannot store non-numeric value as a number.");
 		}
-
-		return *this;
+		setMember(index, f, json_val);
 	}
 
 	template<typename T>
-	parser& parser::saveString(const std::string& key, const T& value, size_t index) {
-		rapidjson::Value& arr = _dsData.GetArray();
-
-		// ȷ㹻index
-		if (index >= arr.Size()) {
-			size_t currentSize = arr.Size();
-			for (size_t i = currentSize; i <= index; ++i) {
-				rapidjson::Value newObj(rapidjson::kObjectType); // ¶
-				arr.PushBack(newObj, *_allocator); // ӵ
-			}
-		}
-
-		rapidjson::Value& obj = arr[index];
-		rapidjson::Value json_key(key.c_str(), *_allocator);
-
-		if constexpr (std::is_arithmetic_v<T>) {
-			std::ostringstream oss;
-			oss << value;
-			rapidjson::Value json_val(oss.str().c_str(), *_allocator);
-			obj.AddMember(json_key, json_val, *_allocator);
-		}
-		else if constexpr (std::is_same_v<T, std::vector<int>> || std::is_same_v<T, std::vector<float>> || std::is_same_v<T, std::vector<std::string>>) {
-			std::ostringstream oss;
-			bool first = true;
-			for (const auto& num : value) {
-				if (!first) oss << " ";
-				oss << num;
-				first = false;
-			}
-			rapidjson::Value json_val(oss.str().c_str(), *_allocator);
-			obj.AddMember(json_key, json_val, *_allocator);
+	void parser::saveString(field f, const T& value, size_t index) const {
+		if constexpr (std::is_same_v<T, std::vector<int>> || std::is_same_v<T, std::vector<float>> || std::is_same_v<T, std::vector<symbol>>) {
+			if (_fieldText.size() <= index) _fieldText.resize(index + 1);
+			if (!_fieldText[index]) _fieldText[index] = std::make_unique<std::array<std::string, field_count>>();
+			std::string& text = (*_fieldText[index])[static_cast<size_t>(f)];
+
+			// ԭд㹻ʱ·䣻DOM еľֵ text漴滻
+			const char* previous = text.data();
+			text.clear();
+			appendVector(text, value);
+			rapidjson::Value json_val(rapidjson::StringRef(text.data(), text.size()));
+			setMember(index, f, json_val, previous);
 		}
 		else {
-			static_assert(false, "Unsupported type for string storage.");
+			static_assert(sizeof(T) == 0, "Unsupported type for string storage.");
 		}
-
-		return *this;
 	}
 
 	// ز
@@ -724,94 +1254,123 @@ namespace DS {
 		const std::vector<float>& element_length_seq,
 		float step
 	) const {
-		if (data_seq.size() != element_length_seq.size() || step <= 0.0f)	return {};
+		return resample<T>(data_seq, element_length_seq, step);
+	}
 
-		std::vector<T> resampled;
-		for (size_t i = 0; i < data_seq.size(); ++i) {
-			const float elem_length = element_length_seq[i];
-			if (elem_length <= 0.0f)										continue;
-			const int repeat = static_cast<int>(std::round(elem_length / step));
-			for (int r = 0; r < repeat; ++r) {
-				resampled.push_back(data_seq[i]);
+	template<typename T>
+	size_t parser::resampling(
+		const std::vector<T>& data_seq,
+		const std::vector<float>& element_length_seq,
+		float step,
+		std::span<T> out
+	) const {
+		return resample<T>(data_seq, element_length_seq, step, out);
+	}
+
+	template<typename T>
+	void appendVector(std::string& out, const std::vector<T>& vec) {
+		char buf[32];
+		for (size_t i = 0; i < vec.size(); ++i) {
+			if (i != 0) out += ' ';
+			if constexpr (std::is_arithmetic_v<T>) {
+				// ҿɾȷصʮƱʾ֤ıƻת
+				auto result = std::to_chars(buf, buf + sizeof(buf), vec[i]);
+				out.append(buf, result.ptr);
+			}
+			else if constexpr (std::is_same_v<T, symbol>) {
+				out += symbol_name(vec[i]);
+			}
+			else {
+				out += vec[i];
 			}
 		}
-
-		return resampled;
 	}
 
 	template<typename T>
 	std::string vectorToString(const std::vector<T>& vec) {
-		std::ostringstream oss;
-		for (size_t i = 0; i < vec.size(); ++i) {
-			if (i != 0) oss << " ";
-			oss << vec[i];
-		}
-		return oss.str();
+		std::string out;
+		appendVector(out, vec);
+		return out;
 	}
 
 	void parser::updateJSONData() {
-		// ԭ JSON 
-		_dsData.SetArray();
+		//  DOM ԭ֯ͬڴһͷţݣʽһؽ
+		resetDom();
+		_dirty.clear();
+		_anyDirty = false;
+		_domReady = false;
+	}
+
+	rapidjson::Document& parser::dom() const {
+		if (_domReady.load(std::memory_order_acquire) && !_anyDirty.load(std::memory_order_acquire)) {
+			return _dsData;
+		}
+		std::lock_guard<std::mutex> lock(_domMutex);
+		if (!_domReady.load(std::memory_order_relaxed)) {
+			buildDom();
+		}
+		else if (_anyDirty.load(std::memory_order_relaxed)) {
+			flushDirty();
+		}
+		return _dsData;
+	}
+
+	void parser::buildDom() const {
+		resetDom();
 		rapidjson::Document::AllocatorType& allocator = _dsData.GetAllocator();
 
-		// ÿһ
-		for (size_t row = 0; row < _phSeq.size(); ++row) {
+		const size_t rows = _offset.size();
+		_dsData.Reserve(static_cast<rapidjson::SizeType>(rows), allocator);
+		std::string text;	// ֶεıɵٿڴأֶ֮临
+		for (size_t row = 0; row < rows; ++row) {
 			rapidjson::Value rowObj(rapidjson::kObjectType);
+			rowObj.MemberReserve(static_cast<rapidjson::SizeType>(field_count), allocator);
+
+			// ȷŻʽʱԭδֶ֪
+			// еֶ֪Σ "offset":nullԭֵΪ׼Ӧв DOM ʽصĽһ
+			// ԭûеֶΣ ph_seq ֳ ph_numͬ
+			uint32_t held = absentFields(row);
+			if (row < _extraJson.size() && !_extraJson[row].empty()) {
+				rapidjson::Document extra(&allocator);
+				extra.Parse(_extraJson[row].c_str(), _extraJson[row].size());
+				if (!extra.HasParseError() && !extra.IsObject()) {
+					// ԭвǶУԭŻ
+					_dsData.PushBack(rapidjson::Value(extra, allocator).Move(), allocator);
+					continue;
+				}
+				if (!extra.HasParseError()) {
+					for (auto it = extra.MemberBegin(); it != extra.MemberEnd(); ++it) {
+						const field f = find_field({ it->name.GetString(), it->name.GetStringLength() });
+						if (f != field::unknown) held |= field_bit(f);
+						rowObj.AddMember(it->name, it->value, allocator);
+					}
+				}
+			}
+
+			forEachColumn(*this, [&](field f, const auto& column) {
+				if (row >= column.size() || (held & field_bit(f))) return;
+				const std::string_view key = field_key(f);
+				if constexpr (std::is_same_v<std::decay_t<decltype(column)>, std::vector<float>>) {
+					// offset ʱδã<= 0ʱ
+					if (f != field::offset && column[row] <= 0.0f) return;
+					rowObj.AddMember(rapidjson::StringRef(key.data(), key.size()), widen(column[row]), allocator);
+				}
+				else {
+					if (column[row].empty()) return;
+					text.clear();
+					appendVector(text, column[row]);
+					rowObj.AddMember(
+						rapidjson::StringRef(key.data(), key.size()),
+						rapidjson::Value(text.data(), static_cast<rapidjson::SizeType>(text.size()), allocator).Move(),
+						allocator
+					);
+				}
+			});
 
-			// ֶ
-			// 1. ph_seq
-			rowObj.AddMember(
-				"ph_seq",
-				rapidjson::Value(vectorToString(_phSeq[row]).c_str(), allocator).Move(),
-				allocator
-			);
-
-			// 2. ph_num
-			rowObj.AddMember(
-				"ph_num",
-				rapidjson::Value(vectorToString(_phNum[row]).c_str(), allocator).Move(),
-				allocator
-			);
-
-			// 3. note_dur
-			rowObj.AddMember(
-				"note_dur",
-				rapidjson::Value(vectorToString(_noteTime[row]).c_str(), allocator).Move(),
-				allocator
-			);
-
-			// 4. note_slur
-			rowObj.AddMember(
-				"note_slur",
-				rapidjson::Value(vectorToString(_noteSlur[row]).c_str(), allocator).Move(),
-				allocator
-			);
-
-			// 5. offset
-			rowObj.AddMember("offset", _offset[row], allocator);
-
-			// 6. note_seq
-			rowObj.AddMember(
-				"note_seq",
-				rapidjson::Value(vectorToString(_noteSeq[row]).c_str(), allocator).Move(),
-				allocator
-			);
-
-			// 6. ph_dur
-			rowObj.AddMember(
-				"ph_dur",
-				rapidjson::Value(vectorToString(_phTime[row]).c_str(), allocator).Move(),
-				allocator
-			);
-
-			// 7. tickTimeӦֶ "f0_timestep"
-			if (row < _f0_ticktime.size()) {
-				rowObj.AddMember("f0_timestep", _f0_ticktime[row], allocator);
-			}
-
-
-			// ǰжӵ JSON 
 			_dsData.PushBack(rowObj.Move(), allocator);
 		}
+		_dirty.clear();
+		_anyDirty = false;
+		_domReady = true;
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,124 @@
+#include "DSmusic.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace DS {
+	namespace {
+		// ǰÿеĳ
+		struct row_length {
+			batch_row source;
+			size_t frames = 0;
+			size_t phonemes = 0;
+		};
+
+		// ʱ֡ÿصı߽簴ۼʱȡص֮֡ʱһ
+		void append_ph_frames(std::span<const float> dur, float step, int64_t* out) {
+			double total = 0.0;
+			int64_t last = 0;
+			for (size_t i = 0; i < dur.size(); ++i) {
+				total += dur[i];
+				const int64_t edge = std::llround(total / step);
+				out[i] = std::max<int64_t>(edge - last, 0);
+				last = std::max(last, edge);
+			}
+		}
+
+		void fill_row(tensor_batch& batch, size_t b, const music& song, int row, const batch_options& options) {
+			const size_t T_ph = batch.phonemes;
+			const size_t T = batch.frames;
+
+			// ά
+			std::span<const symbol> ph = song.viewPhSeq(row);
+			std::span<const float> dur = song.viewPhDur(row);
+			dur = dur.first(std::min(dur.size(), ph.size()));
+			batch.ph_length[b] = static_cast<int64_t>(ph.size());
+			for (size_t i = 0; i < ph.size(); ++i) {
+				batch.ph_ids[b * T_ph + i] = static_cast<int64_t>(song.langSymbol(ph[i]));
+			}
+			std::copy(dur.begin(), dur.end(), batch.ph_dur.begin() + b * T_ph);
+			append_ph_frames(dur, options.step, batch.ph_frames.data() + b * T_ph);
+			std::fill_n(batch.ph_mask.begin() + b * T_ph, ph.size(), uint8_t(1));
+
+			// ֡ά
+			const std::vector<float>& midi = song.getMidiStep(row, options.step);
+			batch.frame_length[b] = static_cast<int64_t>(midi.size());
+			std::copy(midi.begin(), midi.end(), batch.midi.begin() + b * T);
+			std::fill_n(batch.frame_mask.begin() + b * T, midi.size(), uint8_t(1));
+			for (size_t c = 0; c < curve_count; ++c) {
+				const std::vector<float> curve = song.getCurveStep(static_cast<curve_type>(c), row, options.step, options.mode);
+				if (curve.empty()) continue;
+				std::vector<float>& out = batch.curves[c];
+				if (out.empty()) out.assign(batch.rows * T, 0.0f);
+				const size_t copied = std::min(curve.size(), midi.size());
+				std::copy_n(curve.begin(), copied, out.begin() + b * T);
+				std::fill(out.begin() + b * T + copied, out.begin() + b * T + midi.size(), curve.back());
+				batch.has_curve[c][b] = 1;
+			}
+		}
+	}
+
+	std::vector<tensor_batch> make_batches(std::span<const music* const> songs, const batch_options& options) {
+		if (!(options.step > 0.0f)) {
+			throw DsParserError("֡ 0");
+		}
+		if (options.max_rows == 0) {
+			throw DsParserError("ÿ 0");
+		}
+
+		// ֡ȡ getMidiStep ĳȣᱻ棬ʱټ
+		std::vector<row_length> lengths;
+		for (size_t s = 0; s < songs.size(); ++s) {
+			const music& song = *songs[s];
+			const int count = song.getRowCount();
+			for (int row = 0; row < count; ++row) {
+				lengths.push_back({ { s, row }, song.getMidiStep(row, options.step).size(), song.viewPhSeq(row).size() });
+			}
+		}
+		std::stable_sort(lengths.begin(), lengths.end(), [](const row_length& a, const row_length& b) {
+			return a.frames != b.frames ? a.frames < b.frames : a.phonemes < b.phonemes;
+		});
+
+		// ֡Сװ룬 T װһе֡
+		std::vector<tensor_batch> out;
+		for (size_t i = 0; i < lengths.size();) {
+			size_t end = i + 1;
+			while (end < lengths.size() && end - i < options.max_rows &&
+				(options.max_frames == 0 || (end - i + 1) * lengths[end].frames <= options.max_frames)) {
+				++end;
+			}
+
+			tensor_batch& batch = out.emplace_back();
+			batch.rows = end - i;
+			batch.frames = lengths[end - 1].frames;
+			size_t valid = 0;
+			for (size_t j = i; j < end; ++j) {
+				batch.phonemes = std::max(batch.phonemes, lengths[j].phonemes);
+				batch.source.push_back(lengths[j].source);
+				valid += lengths[j].frames;
+			}
+			const size_t B = batch.rows;
+			batch.ph_length.assign(B, 0);
+			batch.ph_ids.assign(B * batch.phonemes, 0);
+			batch.ph_dur.assign(B * batch.phonemes, 0.0f);
+			batch.ph_frames.assign(B * batch.phonemes, 0);
+			batch.ph_mask.assign(B * batch.phonemes, 0);
+			batch.frame_length.assign(B, 0);
+			batch.midi.assign(B * batch.frames, 0.0f);
+			batch.frame_mask.assign(B * batch.frames, 0);
+			for (auto& present : batch.has_curve) present.assign(B, 0);
+			for (size_t b = 0; b < B; ++b) {
+				fill_row(batch, b, *songs[batch.source[b].song], batch.source[b].row, options);
+			}
+			const size_t padded = B * batch.frames;
+			batch.padding = padded > 0 ? 1.0 - static_cast<double>(valid) / static_cast<double>(padded) : 0.0;
+			i = end;
+		}
+		return out;
+	}
+
+	std::vector<tensor_batch> make_batches(const music& song, const batch_options& options) {
+		const music* songs[] = { &song };
+		return make_batches(songs, options);
+	}
+}
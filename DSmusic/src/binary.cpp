@@ -0,0 +1,320 @@
+#include "DSbinary.h"
+#include "DSparser.h"
+
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include <bit>
+#include <cstring>
+#include <unordered_map>
+
+namespace DS {
+	namespace {
+		constexpr size_t align8(size_t n) {
+			return (n + 7) & ~size_t(7);
+		}
+
+		void require_little_endian() {
+			if constexpr (std::endian::native != std::endian::little) {
+				throw DsParserError(" DS ʽ֧Сƽ̨");
+			}
+		}
+
+		// αļ
+		void check_section(const binary::section& s, size_t size, size_t expected) {
+			if (s.offset % 8 != 0 || s.offset > size || s.size > size - s.offset || s.size != expected) {
+				throw DsParserError("ȷĶ DS ʽԽ");
+			}
+		}
+
+		// ƫƱ 0 ʼҲݶ
+		void check_offsets(const uint32_t* offsets, size_t count, size_t dataSize) {
+			if (offsets[0] != 0 || offsets[count] > dataSize) {
+				throw DsParserError("ȷĶ DS ʽƫƱԽ");
+			}
+			for (size_t i = 0; i < count; ++i) {
+				if (offsets[i] > offsets[i + 1]) {
+					throw DsParserError("ȷĶ DS ʽƫƱԽ");
+				}
+			}
+		}
+
+		//  8 ֽڶ׷Ӹ
+		class binary_builder {
+		public:
+			binary_builder() : _out(align8(sizeof(binary::header)), '\0') {}
+
+			template<typename T>
+			binary::section append(const std::vector<T>& values) {
+				return append(values.data(), values.size() * sizeof(T));
+			}
+
+			binary::section append(const void* data, size_t size) {
+				binary::section s{ _out.size(), size };
+				_out.append(static_cast<const char*>(data), size);
+				_out.resize(align8(_out.size()), '\0');
+				return s;
+			}
+
+			std::string finish(const binary::header& header) {
+				std::memcpy(_out.data(), &header, sizeof(header));
+				return std::move(_out);
+			}
+
+		private:
+			std::string _out;
+		};
+	}
+
+	bool binary_reader::detect(const char* data, size_t size) noexcept {
+		return data != nullptr && size >= sizeof(binary::header)
+			&& std::memcmp(data, binary::magic.data(), binary::magic.size()) == 0;
+	}
+
+	binary_reader::binary_reader(const char* data, size_t size)
+		: _data(data), _header(reinterpret_cast<const binary::header*>(data))
+	{
+		require_little_endian();
+		if (!detect(data, size)) {
+			throw DsParserError("ȷĶ DS ʽȱļʶ");
+		}
+		if (_header->version != binary::version) {
+			throw DsParserError("ֵ֧Ķ DS 汾" + std::to_string(_header->version));
+		}
+
+		const size_t rows = _header->rows;
+		check_section(_header->index, size, rows * field_count * sizeof(binary::slice));
+		_index = reinterpret_cast<const binary::slice*>(data + _header->index.offset);
+
+		for (size_t f = 0; f < field_count; ++f) {
+			const binary::section& s = _header->fields[f];
+			check_section(s, size, s.size - s.size % binary::element_size);
+			const size_t elements = s.size / binary::element_size;
+			for (size_t row = 0; row < rows; ++row) {
+				const binary::slice& slice = _index[row * field_count + f];
+				if (slice.first > elements || slice.count > elements - slice.first) {
+					throw DsParserError("ȷĶ DS ʽԽ");
+				}
+			}
+		}
+
+		check_section(_header->symbolOffsets, size, (size_t(_header->symbols) + 1) * sizeof(uint32_t));
+		check_section(_header->symbolData, size, _header->symbolData.size);
+		_symbolOffsets = reinterpret_cast<const uint32_t*>(data + _header->symbolOffsets.offset);
+		check_offsets(_symbolOffsets, _header->symbols, _header->symbolData.size);
+
+		check_section(_header->extraOffsets, size, (rows + 1) * sizeof(uint32_t));
+		check_section(_header->extraData, size, _header->extraData.size);
+		_extraOffsets = reinterpret_cast<const uint32_t*>(data + _header->extraOffsets.offset);
+		check_offsets(_extraOffsets, rows, _header->extraData.size);
+	}
+
+	std::string_view binary_reader::symbol(uint32_t id) const {
+		if (id >= _header->symbols) {
+			throw DsParserError("ȷĶ DS ʽűԽ");
+		}
+		const char* base = _data + _header->symbolData.offset;
+		return { base + _symbolOffsets[id], size_t(_symbolOffsets[id + 1] - _symbolOffsets[id]) };
+	}
+
+	std::string_view binary_reader::extra(size_t row) const {
+		const char* base = _data + _header->extraData.offset;
+		return { base + _extraOffsets[row], size_t(_extraOffsets[row + 1] - _extraOffsets[row]) };
+	}
+
+	void parser::loadBinary(const binary_reader& reader) {
+		const size_t rows = reader.rows();
+		resizeColumns(rows);
+		_extraJson.assign(rows, {});
+
+		// ļڵķűһԻȫַűı
+		std::vector<symbol> symbols(reader.symbols());
+		for (size_t id = 0; id < symbols.size(); ++id) {
+			symbols[id] = intern_symbol(reader.symbol(static_cast<uint32_t>(id)));
+		}
+
+		for (size_t row = 0; row < rows; ++row) {
+			// ûݵֶΪԭûУдʱͬ
+			uint32_t absent = 0;
+			forEachColumn(*this, [&](field f, auto& column) {
+				using column_t = std::decay_t<decltype(column)>;
+				if constexpr (std::is_same_v<column_t, std::vector<float>>) {
+					auto values = reader.values<float>(row, f);
+					if (values.empty()) absent |= field_bit(f);
+					column[row] = values.empty() ? 0.0f : values[0];
+				}
+				else if constexpr (std::is_same_v<column_t, std::vector<std::vector<symbol>>>) {
+					auto ids = reader.values<uint32_t>(row, f);
+					std::vector<symbol>& out = column[row];
+					out.reserve(ids.size());
+					for (uint32_t id : ids) {
+						if (id >= symbols.size()) {
+							throw DsParserError("ȷĶ DS ʽűԽ");
+						}
+						out.push_back(symbols[id]);
+					}
+					if (out.empty()) absent |= field_bit(f);
+				}
+				else {
+					using T = typename column_t::value_type::value_type;
+					using stored = std::conditional_t<std::is_same_v<T, int>, int32_t, float>;
+					auto values = reader.values<stored>(row, f);
+					column[row].assign(values.begin(), values.end());
+					if (values.empty()) absent |= field_bit(f);
+				}
+			});
+			_extraJson[row] = reader.extra(row);
+			_absent[row] = absent;
+			if (_phNum[row].empty()) derivePhNum(row);
+		}
+
+		// ʽͬ DOMҪлʱɸؽ
+		_dsData.SetArray();
+		_domReady = false;
+		_hasData = true;
+		_isLoad = true;
+	}
+
+	std::string parser::extraJson(size_t row) const {
+		if (!_domReady) {
+			return row < _extraJson.size() ? _extraJson[row] : std::string();
+		}
+
+		// ʽȡһ£δֶ֪ΣԼͲֵֶַ֪
+		// Ȱ޸д DOM get()  dom() дصֶζַ֣Ϊ׼
+		const rapidjson::Value& obj = dom()[static_cast<rapidjson::SizeType>(row)];
+		rapidjson::StringBuffer buffer;
+		rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+		if (!obj.IsObject()) {
+			// Ƕ޸ĹдʱѳΪ
+			obj.Accept(writer);
+			return { buffer.GetString(), buffer.GetSize() };
+		}
+		bool any = false;
+		for (auto it = obj.MemberBegin(); it != obj.MemberEnd(); ++it) {
+			field f = find_field({ it->name.GetString(), it->name.GetStringLength() });
+			if (f != field::unknown && (it->value.IsString() || it->value.IsNumber())) continue;
+			if (!any) writer.StartObject();
+			any = true;
+			it->name.Accept(writer);
+			it->value.Accept(writer);
+		}
+		if (!any) return {};
+		writer.EndObject();
+		return { buffer.GetString(), buffer.GetSize() };
+	}
+
+	uint32_t parser::extraFields(std::string_view extra) {
+		uint32_t bits = 0;
+		if (extra.size() <= 2) return bits;
+		rapidjson::Document doc;
+		doc.Parse(extra.data(), extra.size());
+		if (doc.HasParseError() || !doc.IsObject()) return bits;
+		for (auto it = doc.MemberBegin(); it != doc.MemberEnd(); ++it) {
+			const field f = find_field({ it->name.GetString(), it->name.GetStringLength() });
+			if (f != field::unknown) bits |= field_bit(f);
+		}
+		return bits;
+	}
+
+	void parser::dropExtra(size_t row, field f) {
+		if (row >= _extraJson.size() || _extraJson[row].empty()) return;
+		rapidjson::Document doc;
+		doc.Parse(_extraJson[row].c_str(), _extraJson[row].size());
+		if (doc.HasParseError()) return;
+		if (!doc.IsObject()) {
+			// ԭвǶУ޸ĺΪ
+			_extraJson[row].clear();
+			return;
+		}
+		const std::string_view key = field_key(f);
+		auto it = doc.FindMember(rapidjson::StringRef(key.data(), key.size()));
+		if (it == doc.MemberEnd()) return;
+		// Ա˳
+		doc.EraseMember(it);
+		if (doc.MemberCount() == 0) {
+			_extraJson[row].clear();
+			return;
+		}
+		rapidjson::StringBuffer buffer;
+		rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+		doc.Accept(writer);
+		_extraJson[row].assign(buffer.GetString(), buffer.GetSize());
+	}
+
+	std::string parser::getBinary() const {
+		require_little_endian();
+		if (!_isLoad.load(std::memory_order_acquire)) {
+			const_cast<parser*>(this)->load();
+		}
+
+		const size_t rows = _offset.size();
+		binary::header header{};
+		header.magic = binary::magic;
+		header.version = binary::version;
+		header.rows = static_cast<uint32_t>(rows);
+
+		std::vector<binary::slice> index(rows * field_count, binary::slice{ 0, 0 });
+		std::array<std::vector<char>, field_count> data;
+
+		// ȫֱڽû壬ļڰ˳±
+		std::unordered_map<symbol, uint32_t> symbolIds;
+		std::vector<uint32_t> symbolOffsets = { 0 };
+		std::string symbolData;
+
+		auto put = [&](size_t row, field f, const void* values, size_t count) {
+			std::vector<char>& out = data[static_cast<size_t>(f)];
+			index[row * field_count + static_cast<size_t>(f)] = {
+				static_cast<uint32_t>(out.size() / binary::element_size), static_cast<uint32_t>(count)
+			};
+			const char* bytes = static_cast<const char*>(values);
+			out.insert(out.end(), bytes, bytes + count * binary::element_size);
+		};
+
+		std::vector<uint32_t> extraOffsets = { 0 };
+		std::string extraData;
+		std::vector<uint32_t> ids;
+
+		for (size_t row = 0; row < rows; ++row) {
+			// ԭûеֶΣ ph_seq ֳ ph_numݣȡʱٰԭ
+			const uint32_t absent = absentFields(row);
+			forEachColumn(*this, [&](field f, const auto& column) {
+				if (row >= column.size() || (absent & field_bit(f))) return;
+				using column_t = std::decay_t<decltype(column)>;
+				if constexpr (std::is_same_v<column_t, std::vector<float>>) {
+					put(row, f, &column[row], 1);
+				}
+				else if constexpr (std::is_same_v<column_t, std::vector<std::vector<symbol>>>) {
+					ids.clear();
+					for (symbol s : column[row]) {
+						auto [it, added] = symbolIds.try_emplace(s, static_cast<uint32_t>(symbolOffsets.size() - 1));
+						if (added) {
+							symbolData += symbol_name(s);
+							symbolOffsets.push_back(static_cast<uint32_t>(symbolData.size()));
+						}
+						ids.push_back(it->second);
+					}
+					put(row, f, ids.data(), ids.size());
+				}
+				else {
+					put(row, f, column[row].data(), column[row].size());
+				}
+			});
+
+			extraData += extraJson(row);
+			extraOffsets.push_back(static_cast<uint32_t>(extraData.size()));
+		}
+
+		binary_builder out;
+		header.index = out.append(index);
+		for (size_t f = 0; f < field_count; ++f) {
+			header.fields[f] = out.append(data[f]);
+		}
+		header.symbols = static_cast<uint32_t>(symbolOffsets.size() - 1);
+		header.symbolOffsets = out.append(symbolOffsets);
+		header.symbolData = out.append(symbolData.data(), symbolData.size());
+		header.extraOffsets = out.append(extraOffsets);
+		header.extraData = out.append(extraData.data(), extraData.size());
+		return out.finish(header);
+	}
+}
@@ -0,0 +1,107 @@
+#include "DSfile.h"
+#include "DSmusic.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace DS {
+#ifdef _WIN32
+	namespace {
+		std::wstring widen_path(const std::string& path) {
+			if (path.empty()) return {};
+			int length = MultiByteToWideChar(CP_UTF8, 0, path.data(), static_cast<int>(path.size()), nullptr, 0);
+			std::wstring out(length, L'\0');
+			MultiByteToWideChar(CP_UTF8, 0, path.data(), static_cast<int>(path.size()), out.data(), length);
+			return out;
+		}
+	}
+
+	mapped_file::mapped_file(const std::string& path, access mode) {
+		HANDLE file = CreateFileW(
+			widen_path(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+		);
+		if (file == INVALID_HANDLE_VALUE) {
+			throw DsParserError("޷ļ" + path);
+		}
+		_file = file;
+
+		LARGE_INTEGER size{};
+		if (!GetFileSizeEx(file, &size)) {
+			CloseHandle(file);
+			throw DsParserError("޷ȡļС" + path);
+		}
+		_size = static_cast<size_t>(size.QuadPart);
+		if (_size == 0) return; // ļ޷ӳ
+
+		// дʱӳҲֻҪֻʽļ
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr) {
+			CloseHandle(file);
+			throw DsParserError("޷ӳļ" + path);
+		}
+		_mapping = mapping;
+
+		DWORD view = mode == access::copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ;
+		_data = static_cast<char*>(MapViewOfFile(mapping, view, 0, 0, 0));
+		if (_data == nullptr) {
+			CloseHandle(mapping);
+			CloseHandle(file);
+			throw DsParserError("޷ӳļ" + path);
+		}
+
+		SYSTEM_INFO info{};
+		GetSystemInfo(&info);
+		_terminated = _size % info.dwPageSize != 0;
+	}
+
+	mapped_file::~mapped_file() {
+		if (_data) UnmapViewOfFile(_data);
+		if (_mapping) CloseHandle(static_cast<HANDLE>(_mapping));
+		if (_file) CloseHandle(static_cast<HANDLE>(_file));
+	}
+#else
+	mapped_file::mapped_file(const std::string& path, access mode) {
+		_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (_fd < 0) {
+			throw DsParserError("޷ļ" + path);
+		}
+
+		struct stat info {};
+		if (::fstat(_fd, &info) != 0) {
+			::close(_fd);
+			throw DsParserError("޷ȡļС" + path);
+		}
+		_size = static_cast<size_t>(info.st_size);
+		if (_size == 0) return; // ļ޷ӳ
+
+		int protect = mode == access::copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ;
+		void* data = ::mmap(nullptr, _size, protect, MAP_PRIVATE, _fd, 0);
+		if (data == MAP_FAILED) {
+			::close(_fd);
+			throw DsParserError("޷ӳļ" + path);
+		}
+		_data = static_cast<char*>(data);
+		::madvise(_data, _size, MADV_SEQUENTIAL);
+
+		_terminated = _size % static_cast<size_t>(::sysconf(_SC_PAGESIZE)) != 0;
+	}
+
+	mapped_file::~mapped_file() {
+		if (_data) ::munmap(_data, _size);
+		if (_fd >= 0) ::close(_fd);
+	}
+#endif
+}
@@ -1,4 +1,5 @@
 #include "DSparser.h"
+#include "DSnote.h"
 
 #include <vector>
 #include <string>
@@ -15,43 +16,25 @@ namespace DS {
 
     using namespace std;
 
-    float noteNameToMidi(const string& noteName) {
-        static map<string, int> noteMap = {
-            {"C", 0}, {"C#", 1}, {"Db", 1},
-            {"D", 2}, {"D#", 3}, {"Eb", 3},
-            {"E", 4}, {"Fb", 4}, {"E#", 5},
-            {"F", 5}, {"F#", 6}, {"Gb", 6},
-            {"G", 7}, {"G#", 8}, {"Ab", 8},
-            {"A", 9}, {"A#", 10}, {"Bb", 10},
-            {"B", 11}, {"Cb", 11}, {"B#", 0}
-        };
-
-        size_t i = 0;
-        while (i < noteName.size() && (noteName[i] < '0' || noteName[i] > '9') && noteName[i] != '-') {
-            ++i;
-        }
-        string notePart = noteName.substr(0, i);
-        string octavePart = noteName.substr(i);
-
-        auto it = noteMap.find(notePart);
-        if (it == noteMap.end()) {
-            throw invalid_argument("Invalid note name: " + noteName);
+    float noteNameToMidi(string_view noteName) {
+        int midiNumber = note_to_midi(noteName);
+        if (midiNumber == note_invalid) {
+            throw invalid_argument("Invalid note name: " + string(noteName));
         }
-
-        int pitchClass = it->second;
-        int octave = stoi(octavePart);
-        int midiNumber = (octave + 1) * 12 + pitchClass;
         return static_cast<float>(midiNumber);
     }
 
-    vector<float> processMidiWithRest(const vector<string>& notes) {
+    vector<float> processMidiWithRest(const vector<symbol>& notes) {
         int n = notes.size();
         vector<float> midiValues(n, -1.0f);
 
         // ʼMIDIֵ
+        // زɴͬɣǰһͬʱֱ
         for (int i = 0; i < n; ++i) {
-            if (notes[i] != "rest") {
-                midiValues[i] = noteNameToMidi(notes[i]);
+            if (!is_rest(notes[i])) {
+                midiValues[i] = (i > 0 && notes[i] == notes[i - 1])
+                    ? midiValues[i - 1]
+                    : noteNameToMidi(symbol_name(notes[i]));
             }
         }
 
@@ -61,7 +44,7 @@ namespace DS {
         // ǰ¼ЧMIDI
         float currentPrev = -1.0f;
         for (int i = 0; i < n; ++i) {
-            if (notes[i] == "rest") {
+            if (is_rest(notes[i])) {
                 prevMidi[i] = currentPrev;
             }
             else {
@@ -73,7 +56,7 @@ namespace DS {
         // ¼ЧMIDI
         float currentNext = -1.0f;
         for (int i = n - 1; i >= 0; --i) {
-            if (notes[i] == "rest") {
+            if (is_rest(notes[i])) {
                 nextMidi[i] = currentNext;
             }
             else {
@@ -87,7 +70,7 @@ namespace DS {
 
         // ֹ
         for (int i = 0; i < n; ++i) {
-            if (notes[i] == "rest") {
+            if (is_rest(notes[i])) {
                 if (prevMidi[i] != -1.0f) {
                     midiValues[i] = prevMidi[i];
                 }
@@ -104,21 +87,15 @@ namespace DS {
     }
 
     std::vector<float> parser::P_F_conversion(
-        const std::vector<std::string>& notes
+        const std::vector<symbol>& notes
     )const {
-        vector<float> midiValues = processMidiWithRest(notes);
-        vector<float> frequencies;
-        frequencies.reserve(midiValues.size());
-
-        for (float midi : midiValues) {
-            float freq = 440.0f * pow(2.0f, (midi - 69.0f) / 12.0f);
-            frequencies.push_back(freq);
-        }
+        vector<float> frequencies = processMidiWithRest(notes);
+        midi_to_hz(frequencies, frequencies);
         return frequencies;
     }
 
     std::vector<float> parser::P_M_conversion(
-        const std::vector<std::string>& notes
+        const std::vector<symbol>& notes
     )const {
         std::vector<float> midi_float = processMidiWithRest(notes);
         for (int index = 0;index < midi_float.size();++index) {
@@ -0,0 +1,234 @@
+#include "DSmusic.h"
+#include "DSpitch.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DS_PITCH_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DS_PITCH_SSE2
+#endif
+
+namespace DS {
+	namespace {
+		// ³㷨ɱ SIMD 汾ã֤߽λһ
+		constexpr float ln2_12 = 0.057762265046662105f;		// ln2 / 12
+		constexpr float midi_at_1hz = -36.376316562295926f;	// 69 - 12 * log2(440)
+		constexpr float sqrt2 = 1.4142135623730951f;
+		constexpr float log2_c1 = 2.8853900817779268f;		// 2 / ln2
+		constexpr float log2_c3 = log2_c1 / 3.0f;
+		constexpr float log2_c5 = log2_c1 / 5.0f;
+		constexpr float log2_c7 = log2_c1 / 7.0f;
+		constexpr float log2_c9 = log2_c1 / 9.0f;
+		constexpr int min_octave = -126;	// 2^octave Ϊ
+		constexpr int max_octave = 127;
+		constexpr float midi_limit = 2000.0f;	// ʱ磬խתԽ
+
+		// 2^(frac/12)frac  [0, 1)̩չ 4 ףضС float ȣfrac Ϊ 0 ʱǡΪ 1
+		inline float semitone_fraction(float frac) {
+			const float x = frac * ln2_12;
+			return 1.0f + x * (1.0f + x * (0.5f + x * (1.0f / 6.0f + x * (1.0f / 24.0f))));
+		}
+
+		inline float midi_to_hz_scalar(float midi) {
+			if (std::isnan(midi)) return midi;
+			midi = std::clamp(midi, -midi_limit, midi_limit);
+			const float whole = std::floor(midi);
+			if (whole == midi && whole >= 0.0f && whole < 128.0f) {
+				return midi_hz_table[static_cast<size_t>(whole)];	//  MIDI ֱӲ
+			}
+			const float octave = std::clamp(std::floor((whole + 0.5f) / 12.0f), float(min_octave), float(max_octave));
+			const int semitone = std::clamp(static_cast<int>(whole - octave * 12.0f), 0, 11);
+			const float scale = std::bit_cast<float>(static_cast<uint32_t>(static_cast<int>(octave) + 127) << 23);
+			return midi_octave_hz[semitone] * semitone_fraction(midi - whole) * scale;
+		}
+
+		// log2(hz)ָβһ [0.5, 2) atanh 
+		inline float hz_to_midi_scalar(float hz) {
+			if (std::isnan(hz)) return hz;
+			if (hz <= 0.0f) return 0.0f;	// ֡
+			const uint32_t bits = std::bit_cast<uint32_t>(hz);
+			float exponent = static_cast<float>(static_cast<int>(bits >> 23) - 127);
+			float mantissa = std::bit_cast<float>((bits & 0x007fffffu) | 0x3f800000u);
+			if (mantissa > sqrt2) {
+				mantissa *= 0.5f;
+				exponent += 1.0f;
+			}
+			const float t = (mantissa - 1.0f) / (mantissa + 1.0f);
+			const float t2 = t * t;
+			const float log2m = t * (log2_c1 + t2 * (log2_c3 + t2 * (log2_c5 + t2 * (log2_c7 + t2 * log2_c9))));
+			return 12.0f * (exponent + log2m) + midi_at_1hz;
+		}
+
+#if defined(DS_PITCH_AVX2)
+		constexpr size_t lanes = 8;
+
+		inline __m256 midi_to_hz_simd(__m256 input) {
+			const __m256 midi = _mm256_min_ps(_mm256_max_ps(input, _mm256_set1_ps(-midi_limit)), _mm256_set1_ps(midi_limit));
+			const __m256 whole = _mm256_floor_ps(midi);
+			const __m256 frac = _mm256_sub_ps(midi, whole);
+			__m256 octave = _mm256_floor_ps(_mm256_div_ps(_mm256_add_ps(whole, _mm256_set1_ps(0.5f)), _mm256_set1_ps(12.0f)));
+			octave = _mm256_min_ps(_mm256_max_ps(octave, _mm256_set1_ps(float(min_octave))), _mm256_set1_ps(float(max_octave)));
+			__m256i semitone = _mm256_cvttps_epi32(_mm256_sub_ps(whole, _mm256_mul_ps(octave, _mm256_set1_ps(12.0f))));
+			// NaN ת±겻ãǰխ [0, 11]
+			semitone = _mm256_min_epi32(_mm256_max_epi32(semitone, _mm256_setzero_si256()), _mm256_set1_epi32(11));
+			const __m256 base = _mm256_i32gather_ps(midi_octave_hz.data(), semitone, 4);
+			const __m256 scale = _mm256_castsi256_ps(_mm256_slli_epi32(
+				_mm256_add_epi32(_mm256_cvttps_epi32(octave), _mm256_set1_epi32(127)), 23));
+
+			const __m256 x = _mm256_mul_ps(frac, _mm256_set1_ps(ln2_12));
+			__m256 p = _mm256_add_ps(_mm256_set1_ps(1.0f / 6.0f), _mm256_mul_ps(x, _mm256_set1_ps(1.0f / 24.0f)));
+			p = _mm256_add_ps(_mm256_set1_ps(0.5f), _mm256_mul_ps(x, p));
+			p = _mm256_add_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(x, p));
+			p = _mm256_add_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(x, p));
+
+			const __m256 hz = _mm256_mul_ps(_mm256_mul_ps(base, p), scale);
+			return _mm256_blendv_ps(hz, input, _mm256_cmp_ps(input, input, _CMP_UNORD_Q));
+		}
+
+		inline __m256 hz_to_midi_simd(__m256 hz) {
+			const __m256i bits = _mm256_castps_si256(hz);
+			__m256 exponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+			__m256 mantissa = _mm256_castsi256_ps(_mm256_or_si256(
+				_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f800000)));
+			const __m256 high = _mm256_cmp_ps(mantissa, _mm256_set1_ps(sqrt2), _CMP_GT_OQ);
+			mantissa = _mm256_blendv_ps(mantissa, _mm256_mul_ps(mantissa, _mm256_set1_ps(0.5f)), high);
+			exponent = _mm256_add_ps(exponent, _mm256_and_ps(high, _mm256_set1_ps(1.0f)));
+
+			const __m256 t = _mm256_div_ps(_mm256_sub_ps(mantissa, _mm256_set1_ps(1.0f)), _mm256_add_ps(mantissa, _mm256_set1_ps(1.0f)));
+			const __m256 t2 = _mm256_mul_ps(t, t);
+			__m256 p = _mm256_add_ps(_mm256_set1_ps(log2_c7), _mm256_mul_ps(t2, _mm256_set1_ps(log2_c9)));
+			p = _mm256_add_ps(_mm256_set1_ps(log2_c5), _mm256_mul_ps(t2, p));
+			p = _mm256_add_ps(_mm256_set1_ps(log2_c3), _mm256_mul_ps(t2, p));
+			p = _mm256_add_ps(_mm256_set1_ps(log2_c1), _mm256_mul_ps(t2, p));
+			const __m256 log2m = _mm256_mul_ps(t, p);
+
+			__m256 midi = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(12.0f), _mm256_add_ps(exponent, log2m)), _mm256_set1_ps(midi_at_1hz));
+			midi = _mm256_andnot_ps(_mm256_cmp_ps(hz, _mm256_setzero_ps(), _CMP_LE_OQ), midi);	// ֡Ϊ 0
+			return _mm256_blendv_ps(midi, hz, _mm256_cmp_ps(hz, hz, _CMP_UNORD_Q));
+		}
+
+		inline __m256 load(const float* p) { return _mm256_loadu_ps(p); }
+		inline void store(float* p, __m256 v) { _mm256_storeu_ps(p, v); }
+
+		// ֡hz <= 0ƫΪ 0
+		inline __m256 cents_simd(__m256 hz, __m256 midi) {
+			const __m256 cents = _mm256_mul_ps(_mm256_sub_ps(hz_to_midi_simd(hz), midi), _mm256_set1_ps(100.0f));
+			return _mm256_andnot_ps(_mm256_cmp_ps(hz, _mm256_setzero_ps(), _CMP_LE_OQ), cents);
+		}
+#elif defined(DS_PITCH_SSE2)
+		constexpr size_t lanes = 4;
+
+		// SSE2 û floorضϺԸ
+		inline __m128 floor_ps(__m128 v) {
+			const __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+			return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, v), _mm_set1_ps(1.0f)));
+		}
+
+		inline __m128 select(__m128 mask, __m128 a, __m128 b) {
+			return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+		}
+
+		inline __m128 midi_to_hz_simd(__m128 input) {
+			const __m128 midi = _mm_min_ps(_mm_max_ps(input, _mm_set1_ps(-midi_limit)), _mm_set1_ps(midi_limit));
+			const __m128 whole = floor_ps(midi);
+			const __m128 frac = _mm_sub_ps(midi, whole);
+			__m128 octave = floor_ps(_mm_div_ps(_mm_add_ps(whole, _mm_set1_ps(0.5f)), _mm_set1_ps(12.0f)));
+			octave = _mm_min_ps(_mm_max_ps(octave, _mm_set1_ps(float(min_octave))), _mm_set1_ps(float(max_octave)));
+
+			// û gatherȡ
+			alignas(16) int32_t semitone[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(semitone),
+				_mm_cvttps_epi32(_mm_sub_ps(whole, _mm_mul_ps(octave, _mm_set1_ps(12.0f)))));
+			auto entry = [](int32_t s) { return midi_octave_hz[static_cast<size_t>(std::clamp(s, 0, 11))]; };
+			const __m128 base = _mm_set_ps(entry(semitone[3]), entry(semitone[2]), entry(semitone[1]), entry(semitone[0]));
+			const __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(
+				_mm_add_epi32(_mm_cvttps_epi32(octave), _mm_set1_epi32(127)), 23));
+
+			const __m128 x = _mm_mul_ps(frac, _mm_set1_ps(ln2_12));
+			__m128 p = _mm_add_ps(_mm_set1_ps(1.0f / 6.0f), _mm_mul_ps(x, _mm_set1_ps(1.0f / 24.0f)));
+			p = _mm_add_ps(_mm_set1_ps(0.5f), _mm_mul_ps(x, p));
+			p = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(x, p));
+			p = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(x, p));
+
+			const __m128 hz = _mm_mul_ps(_mm_mul_ps(base, p), scale);
+			return select(_mm_cmpunord_ps(input, input), input, hz);
+		}
+
+		inline __m128 hz_to_midi_simd(__m128 hz) {
+			const __m128i bits = _mm_castps_si128(hz);
+			__m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+			__m128 mantissa = _mm_castsi128_ps(_mm_or_si128(
+				_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+			const __m128 high = _mm_cmpgt_ps(mantissa, _mm_set1_ps(sqrt2));
+			mantissa = select(high, _mm_mul_ps(mantissa, _mm_set1_ps(0.5f)), mantissa);
+			exponent = _mm_add_ps(exponent, _mm_and_ps(high, _mm_set1_ps(1.0f)));
+
+			const __m128 t = _mm_div_ps(_mm_sub_ps(mantissa, _mm_set1_ps(1.0f)), _mm_add_ps(mantissa, _mm_set1_ps(1.0f)));
+			const __m128 t2 = _mm_mul_ps(t, t);
+			__m128 p = _mm_add_ps(_mm_set1_ps(log2_c7), _mm_mul_ps(t2, _mm_set1_ps(log2_c9)));
+			p = _mm_add_ps(_mm_set1_ps(log2_c5), _mm_mul_ps(t2, p));
+			p = _mm_add_ps(_mm_set1_ps(log2_c3), _mm_mul_ps(t2, p));
+			p = _mm_add_ps(_mm_set1_ps(log2_c1), _mm_mul_ps(t2, p));
+			const __m128 log2m = _mm_mul_ps(t, p);
+
+			__m128 midi = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(12.0f), _mm_add_ps(exponent, log2m)), _mm_set1_ps(midi_at_1hz));
+			midi = _mm_andnot_ps(_mm_cmple_ps(hz, _mm_setzero_ps()), midi);	// ֡Ϊ 0
+			return select(_mm_cmpunord_ps(hz, hz), hz, midi);
+		}
+
+		inline __m128 load(const float* p) { return _mm_loadu_ps(p); }
+		inline void store(float* p, __m128 v) { _mm_storeu_ps(p, v); }
+
+		// ֡hz <= 0ƫΪ 0
+		inline __m128 cents_simd(__m128 hz, __m128 midi) {
+			const __m128 cents = _mm_mul_ps(_mm_sub_ps(hz_to_midi_simd(hz), midi), _mm_set1_ps(100.0f));
+			return _mm_andnot_ps(_mm_cmple_ps(hz, _mm_setzero_ps()), cents);
+		}
+#endif
+	}
+
+	void midi_to_hz(std::span<const float> midi, std::span<float> hz) {
+		const size_t n = std::min(midi.size(), hz.size());
+		size_t i = 0;
+#if defined(DS_PITCH_AVX2) || defined(DS_PITCH_SSE2)
+		for (; i + lanes <= n; i += lanes) {
+			store(hz.data() + i, midi_to_hz_simd(load(midi.data() + i)));
+		}
+#endif
+		for (; i < n; ++i) {
+			hz[i] = midi_to_hz_scalar(midi[i]);
+		}
+	}
+
+	void hz_to_midi(std::span<const float> hz, std::span<float> midi) {
+		const size_t n = std::min(hz.size(), midi.size());
+		size_t i = 0;
+#if defined(DS_PITCH_AVX2) || defined(DS_PITCH_SSE2)
+		for (; i + lanes <= n; i += lanes) {
+			store(midi.data() + i, hz_to_midi_simd(load(hz.data() + i)));
+		}
+#endif
+		for (; i < n; ++i) {
+			midi[i] = hz_to_midi_scalar(hz[i]);
+		}
+	}
+
+	void hz_to_cents(std::span<const float> hz, std::span<const float> midi, std::span<float> cents) {
+		const size_t n = std::min({ hz.size(), midi.size(), cents.size() });
+		size_t i = 0;
+#if defined(DS_PITCH_AVX2) || defined(DS_PITCH_SSE2)
+		for (; i + lanes <= n; i += lanes) {
+			store(cents.data() + i, cents_simd(load(hz.data() + i), load(midi.data() + i)));
+		}
+#endif
+		for (; i < n; ++i) {
+			cents[i] = hz[i] <= 0.0f ? 0.0f : (hz_to_midi_scalar(hz[i]) - midi[i]) * 100.0f;
+		}
+	}
+}
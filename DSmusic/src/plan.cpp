@@ -0,0 +1,250 @@
+#include "DSparser.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace DS {
+	namespace {
+		// һϲǰΪֹ״̬ʱļ pack ĺϲͬ
+		struct group_state {
+			float start = 0.0f;		// е offset
+			float total = 0.0f;		// ϲʱ
+			size_t phonemes = 0;
+			bool restEnd = false;	// ǰ SP βһнʱٲֹ
+		};
+
+		// һУʼ offsetӵĩβʱʵм 0.2 
+		float next_interval(const group_state& g, float offset) {
+			return offset - (g.start + g.total) + 0.2;
+		}
+
+		// һУΪҵǰ SP βʱpack ȲһֹSP
+		void append_row(group_state& g, float interval, float total, size_t phonemes, bool restEnd) {
+			const bool rest = interval > 0 && !g.restEnd;
+			g.total += interval + total;
+			g.phonemes += phonemes + (rest ? 1 : 0);
+			g.restEnd = phonemes != 0 ? restEnd : (g.restEnd || rest);
+		}
+
+		double group_cost(const pack_cost& cost, double seconds, size_t phonemes) {
+			const double frames = seconds / cost.step;
+			return cost.frame_weight * frames + cost.phoneme_weight * static_cast<double>(phonemes)
+				+ cost.attention_weight * frames * frames;
+		}
+
+		void check_cost(const pack_cost& cost) {
+			if (!(cost.step > 0.0f)) {
+				throw DsParserError("ģ͵֡ 0");
+			}
+		}
+
+		// ȫĴۡ
+		void finish_plan(pack_plan& plan, const pack_cost& cost) {
+			double largest = 0.0;
+			plan.cost = 0.0;
+			for (pack_group& g : plan.groups) {
+				g.cost = group_cost(cost, g.seconds, g.phonemes);
+				plan.cost += g.cost;
+				largest = std::max(largest, g.cost);
+			}
+			plan.padded = largest * static_cast<double>(plan.groups.size());
+			plan.padding = plan.padded > 0.0 ? 1.0 - plan.cost / plan.padded : 0.0;
+		}
+	}
+
+	parser::pack_rows parser::packRows() const {
+		if (!_isLoad.load(std::memory_order_acquire)) {
+			const_cast<parser*>(this)->load();
+		}
+		touchAll(field::offset);
+		touchAll(field::note_dur);
+		touchAll(field::ph_seq);
+
+		// set ϵпֻչ˲Уȱٵİд
+		const size_t rows = getRowCount();
+		pack_rows out;
+		out.total.assign(rows, 0.0f);
+		out.phonemes.assign(rows, 0);
+		out.restEnd.assign(rows, false);
+		for (size_t row = 0; row < rows; ++row) {
+			if (row < _noteTime.size()) {
+				out.total[row] = std::accumulate(_noteTime[row].begin(), _noteTime[row].end(), 0.0f);
+			}
+			if (row < _phSeq.size() && !_phSeq[row].empty()) {
+				out.phonemes[row] = _phSeq[row].size();
+				out.restEnd[row] = _phSeq[row].back() == symbols::SP;
+			}
+		}
+		return out;
+	}
+
+	pack_plan parser::planPack(float time_s, float maxInterval_s, const pack_cost& cost) const {
+		check_cost(cost);
+		const pack_rows rows = packRows();
+		const size_t count = rows.total.size();
+		auto offset = [&](size_t row) { return row < _offset.size() ? _offset[row] : 0.0f; };
+		auto begin = [&](size_t row) {
+			return group_state{ offset(row), rows.total[row], rows.phonemes[row], rows.restEnd[row] };
+		};
+		auto append = [&](group_state& g, float interval, size_t row) {
+			append_row(g, interval, rows.total[row], rows.phonemes[row], rows.restEnd[row]);
+		};
+
+		pack_plan plan;
+		size_t i = 0;
+		while (i < count) {
+			group_state g = begin(i);
+			size_t end = i + 1;
+			while (end < count) {
+				const float interval = next_interval(g, offset(end));
+				if ((g.total + interval + rows.total[end] > time_s) ||
+					(interval > maxInterval_s)
+					) break;
+				append(g, interval, end);
+				++end;
+			}
+			plan.groups.push_back({ i, end - i });
+			i = end;
+		}
+		placeRows(plan, rows);
+		finish_plan(plan, cost);
+		return plan;
+	}
+
+	pack_plan parser::planPackBalanced(double budget, float maxInterval_s, const pack_cost& cost) const {
+		check_cost(cost);
+		if (!(budget > 0.0)) {
+			throw DsParserError("Ԥ 0");
+		}
+		const pack_rows rows = packRows();
+		const size_t count = rows.total.size();
+		auto offset = [&](size_t row) { return row < _offset.size() ? _offset[row] : 0.0f; };
+		auto begin = [&](size_t row) {
+			return group_state{ offset(row), rows.total[row], rows.phonemes[row], rows.restEnd[row] };
+		};
+		auto append = [&](group_state& g, float interval, size_t row) {
+			append_row(g, interval, rows.total[row], rows.phonemes[row], rows.restEnd[row]);
+		};
+
+		//  a ͷ죬ζ [a, b)  visit(b, ) cap мֹͣ
+		// һг cap ʱԳһ
+		auto extend = [&](size_t a, double cap, auto&& visit) {
+			group_state g = begin(a);
+			for (size_t b = a + 1; b <= count; ++b) {
+				if (b > a + 1) {
+					const float interval = next_interval(g, offset(b - 1));
+					if (interval > maxInterval_s) break;
+					append(g, interval, b - 1);
+				}
+				const double c = group_cost(cost, g.total, g.phonemes);
+				if (b > a + 1 && c > cap) break;
+				visit(b, c);
+			}
+		};
+		// Ϊ cap ʱҾϲ
+		auto fewest = [&](double cap) {
+			size_t groups = 0;
+			for (size_t a = 0; a < count; ++groups) {
+				size_t reach = a + 1;
+				extend(a, cap, [&](size_t b, double) { reach = b; });
+				a = reach;
+			}
+			return groups;
+		};
+
+		// ϲĸʱ䵽һУܴԼΪ  * 
+		// ޲Ԥ㣺ĵԤ֮䰴ȱȡޣѡ  *  С
+		// ٶֳСޣһ˾
+		double floor = 0.0;
+		for (size_t row = 0; row < count; ++row) {
+			floor = std::max(floor, group_cost(cost, rows.total[row], rows.phonemes[row]));
+		}
+		floor = std::min(floor, budget);
+		constexpr int candidates = 64;
+		double cap = budget;
+		size_t target = fewest(budget);
+		for (int k = 0; k < candidates; ++k) {
+			const double c = floor * std::pow(budget / floor, static_cast<double>(k) / candidates);
+			const size_t groups = fewest(c);
+			if (static_cast<double>(groups) * c < static_cast<double>(target) * cap) {
+				cap = c;
+				target = groups;
+			}
+		}
+		double low = floor;
+		for (int k = 0; k < 48 && cap - low > cap * 1e-9; ++k) {
+			const double mid = 0.5 * (low + cap);
+			if (fewest(mid) <= target) cap = mid;
+			else low = mid;
+		}
+
+		// 󻮷֣ȱٱȸ֮ƽͣʹ鳤Ⱦһ
+		// best[b]from[b]ǰ b еֵһ
+		using score = std::pair<size_t, double>;
+		const score none{ std::numeric_limits<size_t>::max(), 0.0 };
+		std::vector<score> best(count + 1, none);
+		std::vector<size_t> from(count + 1, 0);
+		best[0] = { 0, 0.0 };
+		for (size_t a = 0; a < count; ++a) {
+			extend(a, cap, [&](size_t b, double c) {
+				// һгʱ޷ٷ֣Ƴͷ
+				const double slack = c < cap ? cap - c : 0.0;
+				const score value{ best[a].first + 1, best[a].second + slack * slack };
+				if (value < best[b]) {
+					best[b] = value;
+					from[b] = a;
+				}
+			});
+		}
+
+		pack_plan plan;
+		for (size_t b = count; b > 0; b = from[b]) {
+			plan.groups.push_back({ from[b], b - from[b] });
+		}
+		std::reverse(plan.groups.begin(), plan.groups.end());
+		placeRows(plan, rows);
+		finish_plan(plan, cost);
+		return plan;
+	}
+
+	void parser::placeRows(pack_plan& plan, const pack_rows& rows) const {
+		auto offset = [&](size_t row) { return row < _offset.size() ? _offset[row] : 0.0f; };
+		plan.rows.assign(rows.total.size(), {});
+		for (size_t index = 0; index < plan.groups.size(); ++index) {
+			pack_group& group = plan.groups[index];
+			group_state g{ offset(group.first), rows.total[group.first], rows.phonemes[group.first], rows.restEnd[group.first] };
+			plan.rows[group.first] = { index, 0.0, rows.total[group.first] };
+			for (size_t row = group.first + 1; row < group.first + group.count; ++row) {
+				const float interval = next_interval(g, offset(row));
+				plan.rows[row] = { index, static_cast<double>(g.total + interval), rows.total[row] };
+				append_row(g, interval, rows.total[row], rows.phonemes[row], rows.restEnd[row]);
+			}
+			group.offset = g.start;
+			group.seconds = g.total;
+			group.phonemes = g.phonemes;
+		}
+	}
+
+	void parser::checkPlan(const pack_plan& plan) const {
+		const size_t rows = getRowCount();
+		size_t covered = 0;
+		bool valid = true;
+		for (const pack_group& group : plan.groups) {
+			valid = valid && group.first == covered && group.count > 0;
+			covered += group.count;
+		}
+		if (!valid || covered != rows) {
+			throw DsParserError("ݵв");
+		}
+	}
+
+	size_t pack_row::first_frame(float step) const {
+		return static_cast<size_t>(std::max<long long>(std::llround(start / step), 0));
+	}
+
+	size_t pack_row::end_frame(float step) const {
+		return std::max(first_frame(step), static_cast<size_t>(std::max<long long>(std::llround((start + seconds) / step), 0)));
+	}
+}
@@ -0,0 +1,142 @@
+#include "DSresample.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace DS {
+	namespace {
+		// ֵʽڲѭ֧λԽʱ±ǯλȡһ㣬ڱ
+		// λ double 㣬ϵСҲʧ
+
+		void nearest(std::span<const float> y, double ratio, std::span<float> out) {
+			const size_t last = y.size() - 1;
+			for (size_t j = 0; j < out.size(); ++j) {
+				const size_t i = std::min(static_cast<size_t>(j * ratio + 0.5), last);
+				out[j] = y[i];
+			}
+		}
+
+		void linear(std::span<const float> y, double ratio, std::span<float> out) {
+			const size_t last = y.size() - 1;
+			for (size_t j = 0; j < out.size(); ++j) {
+				const double x = j * ratio;
+				const size_t i = std::min(static_cast<size_t>(x), last);
+				const size_t k = std::min(i + 1, last);
+				const float t = static_cast<float>(std::min(x - static_cast<double>(i), 1.0));
+				out[j] = y[i] + t * (y[k] - y[i]);
+			}
+		}
+
+		// Fritsch-Carlson βֵȾ
+		// ڲбȡֵĵƽŻһΪ 0 ʱȡ 0˵ȡ
+		void cubic(std::span<const float> y, double ratio, std::span<float> out) {
+			const size_t n = y.size();
+			const size_t last = n - 1;
+			std::vector<float> m(n);
+			m[0] = y[1] - y[0];
+			m[last] = y[last] - y[last - 1];
+			for (size_t k = 1; k < last; ++k) {
+				const float d0 = y[k] - y[k - 1];
+				const float d1 = y[k + 1] - y[k];
+				m[k] = d0 * d1 > 0.0f ? 2.0f * d0 * d1 / (d0 + d1) : 0.0f;
+			}
+
+			for (size_t j = 0; j < out.size(); ++j) {
+				const double x = j * ratio;
+				const size_t i = std::min(static_cast<size_t>(x), last);
+				const size_t k = std::min(i + 1, last);
+				const float t = static_cast<float>(std::min(x - static_cast<double>(i), 1.0));
+				const float t2 = t * t;
+				const float t3 = t2 * t;
+				const float h00 = 2.0f * t3 - 3.0f * t2 + 1.0f;
+				const float h10 = t3 - 2.0f * t2 + t;
+				const float h01 = -2.0f * t3 + 3.0f * t2;
+				const float h11 = t3 - t2;
+				out[j] = h00 * y[i] + h10 * m[i] + h01 * y[k] + h11 * m[k];
+			}
+		}
+	}
+
+	size_t curve_frames(size_t points, float timestep, float step) {
+		if (timestep <= 0.0f || step <= 0.0f) return 0;
+		return static_cast<size_t>(std::llround(
+			static_cast<double>(points) * static_cast<double>(timestep) / static_cast<double>(step)));
+	}
+
+	void resample_curve(std::span<const float> curve, float timestep, float step, interp_mode mode, std::span<float> out) {
+		if (curve.empty() || out.empty() || timestep <= 0.0f || step <= 0.0f) return;
+		if (curve.size() == 1) {
+			std::fill(out.begin(), out.end(), curve[0]);
+			return;
+		}
+
+		const double ratio = static_cast<double>(step) / static_cast<double>(timestep);
+		switch (mode) {
+		case interp_mode::nearest:	nearest(curve, ratio, out); break;
+		case interp_mode::linear:	linear(curve, ratio, out); break;
+		case interp_mode::cubic:	cubic(curve, ratio, out); break;
+		}
+	}
+
+	std::vector<float> resample_curve(std::span<const float> curve, float timestep, float step, interp_mode mode) {
+		std::vector<float> out(curve_frames(curve.size(), timestep, step));
+		resample_curve(curve, timestep, step, mode, out);
+		return out;
+	}
+
+	std::vector<float> splice_curves(std::span<const curve_piece> pieces, float step, double end, const pack_options& options) {
+		std::vector<float> out;
+		if (step <= 0.0f) return out;
+
+		// ϶ [out.size(), frame) 䣻next Ϊһεĵһ֡ûкһʱ hold 
+		auto fill = [&](size_t frame, const float* next) {
+			if (frame <= out.size()) return;
+			const size_t first = out.size();
+			if (options.fill == gap_fill::constant || first == 0) {
+				// ͷĿ϶ûǰһο
+				const float value = options.fill == gap_fill::constant || next == nullptr ? options.fill_value : *next;
+				out.resize(frame, value);
+				return;
+			}
+			const float last = out.back();
+			if (options.fill == gap_fill::linear && next != nullptr) {
+				const size_t count = frame - first;
+				out.resize(frame);
+				for (size_t k = 0; k < count; ++k) {
+					const float t = static_cast<float>(k + 1) / static_cast<float>(count + 1);
+					out[first + k] = last + t * (*next - last);
+				}
+				return;
+			}
+			out.resize(frame, last);
+		};
+
+		const double inv = 1.0 / static_cast<double>(step);
+		bool any = false;
+		for (const curve_piece& piece : pieces) {
+			if (piece.curve.empty() || piece.timestep <= 0.0f) continue;
+			any = true;
+			const size_t frame = static_cast<size_t>(std::max<long long>(std::llround(piece.start * inv), 0));
+			const size_t frames = piece.timestep == step ? piece.curve.size() : curve_frames(piece.curve.size(), piece.timestep, step);
+			if (frames == 0) continue;
+
+			// زĵһ֡ߵĵһ
+			if (frame < out.size()) out.resize(frame);
+			else fill(frame, &piece.curve.front());
+
+			if (piece.timestep == step) {
+				out.insert(out.end(), piece.curve.begin(), piece.curve.end());
+			}
+			else {
+				out.resize(frame + frames);
+				resample_curve(piece.curve, piece.timestep, step, options.mode, std::span<float>(out).subspan(frame));
+			}
+		}
+
+		// ĩβûʱ뵽н
+		if (any && !pieces.empty() && (pieces.back().curve.empty() || pieces.back().timestep <= 0.0f)) {
+			fill(static_cast<size_t>(std::max<long long>(std::llround(end * inv), 0)), nullptr);
+		}
+		return out;
+	}
+}
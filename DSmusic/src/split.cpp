@@ -0,0 +1,285 @@
+#include "DSparser.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace DS {
+	namespace {
+		constexpr double boundary_eps = 1e-3;	// ߽ر߽Ϊغϵ룩
+
+		// еʱϵλ
+		// split Ϊʱڵ note  phoneme صڲһΪֱǰΣ֮ǰ
+		struct cut_point {
+			double note_time = 0.0;
+			double ph_time = 0.0;
+			size_t note = 0;
+			size_t phoneme = 0;
+			bool split = false;
+			bool pause = false;		// ֹеͣ
+		};
+
+		// зֺһУԭʼ row е leftright ֮Ĳ֣δзֵûе
+		struct piece_source {
+			size_t row = 0;
+			const cut_point* left = nullptr;
+			const cut_point* right = nullptr;
+		};
+
+		std::vector<double> cumulative(const std::vector<float>& dur) {
+			std::vector<double> out(dur.size() + 1, 0.0);
+			for (size_t i = 0; i < dur.size(); ++i) out[i + 1] = out[i] + dur[i];
+			return out;
+		}
+
+		size_t frame_at(double time, float step) {
+			return static_cast<size_t>(std::max<long long>(std::llround(time / step), 0));
+		}
+
+		// һʱе֮Ԫ [begin, end)
+		struct range {
+			size_t begin = 0;
+			size_t end = 0;
+		};
+
+		template<bool notes>
+		range slice_range(size_t count, const cut_point* left, const cut_point* right) {
+			auto index = [](const cut_point* c) { return notes ? c->note : c->phoneme; };
+			return {
+				left ? index(left) : 0,
+				right ? index(right) + (right->split ? 1 : 0) : count
+			};
+		}
+
+		// е֮ʱеֿβԪذе¼㣬ౣԭֵ
+		template<bool notes>
+		std::vector<float> slice_durations(const std::vector<float>& dur, const std::vector<double>& cum, range r,
+			const cut_point* left, const cut_point* right) {
+			auto time = [](const cut_point* c) { return notes ? c->note_time : c->ph_time; };
+			std::vector<float> out(dur.begin() + r.begin, dur.begin() + r.end);
+			if (out.empty()) return out;
+			const double head = left && left->split ? time(left) : cum[r.begin];
+			const double tail = right && right->split ? time(right) : cum[r.end];
+			if (left && left->split) {
+				out.front() = static_cast<float>((out.size() == 1 ? tail : cum[r.begin + 1]) - head);
+			}
+			if (right && right->split) {
+				out.back() = static_cast<float>(tail - (out.size() == 1 ? head : cum[r.end - 1]));
+			}
+			return out;
+		}
+
+		template<typename T>
+		std::vector<T> slice_values(const std::vector<T>& values, range r) {
+			const size_t end = std::min(r.end, values.size());
+			return r.begin < end ? std::vector<T>(values.begin() + r.begin, values.begin() + end) : std::vector<T>();
+		}
+	}
+
+	size_t split_piece::first_frame(float step) const {
+		return frame_at(start, step);
+	}
+
+	size_t split_piece::end_frame(float step) const {
+		return std::max(first_frame(step), frame_at(start + seconds, step));
+	}
+
+	split_plan parser::splitLongRows(float max_s, bool prefer_breaks) {
+		if (!(max_s > 0.0f)) {
+			throw DsParserError("зֳȱ 0");
+		}
+		if (!_isLoad)  load();
+		settle();
+		const size_t rows = getRowCount();
+		resizeColumns(rows);
+
+		// ÿее㣻ʱһµ޷ʱߣз
+		std::vector<std::vector<cut_point>> cuts(rows);
+		std::vector<double> totals(rows, 0.0);
+		for (size_t row = 0; row < rows; ++row) {
+			const std::vector<symbol>& notes = _noteSeq[row];
+			const std::vector<symbol>& phonemes = _phSeq[row];
+			const std::vector<double> noteCum = cumulative(_noteTime[row]);
+			const std::vector<double> phCum = cumulative(_phTime[row]);
+			const double total = noteCum.back();
+			totals[row] = total;
+			if (total <= max_s || notes.size() != _noteTime[row].size() || phonemes.size() != _phTime[row].size()) continue;
+
+			// ѡе㣬ʱ
+			// ͣ٣ֹͣصĲִмпûʱֹм
+			// ߽磺߽ر߽غϣҺһ
+			std::vector<cut_point> candidates;
+			size_t p = 0;
+			for (size_t k = 0; k < notes.size(); ++k) {
+				const double ns = noteCum[k], ne = noteCum[k + 1];
+				if (k > 0 && (k >= _noteSlur[row].size() || _noteSlur[row][k] == 0)) {
+					while (p < phonemes.size() && phCum[p] < ns - boundary_eps) ++p;
+					if (phonemes.empty()) {
+						candidates.push_back({ ns, ns, k, 0, false, false });
+					}
+					else if (p > 0 && p < phonemes.size() && std::abs(phCum[p] - ns) < boundary_eps) {
+						candidates.push_back({ ns, phCum[p], k, p, false, false });
+					}
+				}
+				if (!is_rest(notes[k]) || !(ne > ns)) continue;
+				if (phonemes.empty()) {
+					const double t = 0.5 * (ns + ne);
+					candidates.push_back({ t, t, k, 0, true, true });
+					continue;
+				}
+				for (size_t i = p > 0 ? p - 1 : 0; i < phonemes.size() && phCum[i] < ne; ++i) {
+					const double lo = std::max(ns, phCum[i]), hi = std::min(ne, phCum[i + 1]);
+					if (is_pause(phonemes[i]) && hi - lo > 2 * boundary_eps) {
+						const double t = 0.5 * (lo + hi);
+						candidates.push_back({ t, t, k, i, true, true });
+					}
+				}
+			}
+			std::stable_sort(candidates.begin(), candidates.end(),
+				[](const cut_point& a, const cut_point& b) { return a.note_time < b.note_time; });
+
+			// ǰУĿΪʣಿ־ֺĳȣڲ max_s еȡӽĿ
+			// Χûеʱȡ֮һöλᳬ max_s
+			std::vector<cut_point>& chosen = cuts[row];
+			double start = 0.0;
+			while (total - start > max_s) {
+				const double pieces = std::ceil((total - start) / max_s);
+				const double target = start + (total - start) / pieces;
+				auto usable = [&](const cut_point& c) {
+					if (c.note_time <= start + boundary_eps || c.note_time >= total - boundary_eps) return false;
+					if (chosen.empty()) return true;
+					const cut_point& last = chosen.back();
+					return c.note >= last.note && c.phoneme >= last.phoneme && c.ph_time > last.ph_time + boundary_eps;
+				};
+				const cut_point* best = nullptr;
+				for (int pass = prefer_breaks ? 0 : 1; pass < 2 && !best; ++pass) {
+					for (const cut_point& c : candidates) {
+						if (c.note_time > start + max_s) break;
+						if (!usable(c) || (pass == 0 && !c.pause)) continue;
+						if (!best || std::abs(c.note_time - target) < std::abs(best->note_time - target)) best = &c;
+					}
+				}
+				if (!best) {
+					for (const cut_point& c : candidates) {
+						if (usable(c)) {
+							best = &c;
+							break;
+						}
+					}
+				}
+				if (!best) break;
+				chosen.push_back(*best);
+				start = best->note_time;
+			}
+		}
+
+		std::vector<piece_source> sources;
+		split_plan plan;
+		plan.rows = rows;
+		for (size_t row = 0; row < rows; ++row) {
+			const std::vector<cut_point>& c = cuts[row];
+			for (size_t p = 0; p <= c.size(); ++p) {
+				const piece_source source{ row, p > 0 ? &c[p - 1] : nullptr, p < c.size() ? &c[p] : nullptr };
+				const double start = source.left ? source.left->note_time : 0.0;
+				const double end = source.right ? source.right->note_time : totals[row];
+				sources.push_back(source);
+				plan.pieces.push_back({ row, start, end - start });
+			}
+		}
+
+		// Уδзֱֵ
+		parser out(_language);
+		std::array<void*, field_count> targets{};
+		forEachColumn(out, [&](field f, auto& column) { targets[static_cast<size_t>(f)] = &column; });
+		out.resizeColumns(sources.size());
+		out._extraJson.resize(sources.size());
+		for (size_t n = 0; n < sources.size(); ++n) {
+			const piece_source& s = sources[n];
+			const size_t row = s.row;
+			if (cuts[row].empty()) {
+				out._phSeq[n] = std::move(_phSeq[row]);
+				out._phNum[n] = std::move(_phNum[row]);
+				out._phTime[n] = std::move(_phTime[row]);
+				out._noteSeq[n] = std::move(_noteSeq[row]);
+				out._noteTime[n] = std::move(_noteTime[row]);
+				out._noteSlur[n] = std::move(_noteSlur[row]);
+				out._offset[n] = _offset[row];
+				out._extraJson[n] = extraJson(row);
+				out._absent[n] = absentFields(row);
+				continue;
+			}
+			const range notes = slice_range<true>(_noteSeq[row].size(), s.left, s.right);
+			const range phonemes = slice_range<false>(_phSeq[row].size(), s.left, s.right);
+			out._noteSeq[n] = slice_values(_noteSeq[row], notes);
+			out._noteTime[n] = slice_durations<true>(_noteTime[row], cumulative(_noteTime[row]), notes, s.left, s.right);
+			out._noteSlur[n] = slice_values(_noteSlur[row], notes);
+			if (s.left && s.left->split && !out._noteSlur[n].empty()) out._noteSlur[n].front() = 0;
+			out._phSeq[n] = slice_values(_phSeq[row], phonemes);
+			out._phTime[n] = slice_durations<false>(_phTime[row], cumulative(_phTime[row]), phonemes, s.left, s.right);
+			out._phNum[n] = makePhNum(out._phSeq[n]);
+			// offset ѺƵε㣬
+			out._absent[n] = absentFields(row) & ~field_bit(field::offset);
+			out._offset[n] = _offset[row] + static_cast<float>(plan.pieces[n].start);
+		}
+
+		// ߰ԵĲʱ֡пÿεһεʼ֡Ϊֹһȡĩβ
+		std::vector<std::vector<float>>* curves = nullptr;
+		forEachColumn(*this, [&](field f, auto& column) {
+			using column_t = std::decay_t<decltype(column)>;
+			if (f < field::f0_seq) return;
+			if constexpr (std::is_same_v<column_t, std::vector<std::vector<float>>>) {
+				curves = &column;
+			}
+			else if constexpr (std::is_same_v<column_t, std::vector<float>>) {
+				auto& outCurves = *static_cast<std::vector<std::vector<float>>*>(targets[static_cast<size_t>(f) - 1]);
+				auto& outSteps = *static_cast<std::vector<float>*>(targets[static_cast<size_t>(f)]);
+				for (size_t n = 0; n < sources.size(); ++n) {
+					const piece_source& s = sources[n];
+					std::vector<float>& curve = (*curves)[s.row];
+					const float step = column[s.row];
+					if (cuts[s.row].empty()) {
+						outCurves[n] = std::move(curve);
+						outSteps[n] = step;
+						continue;
+					}
+					if (curve.empty() || step <= 0.0f) continue;
+					const split_piece& piece = plan.pieces[n];
+					const size_t first = std::min(piece.first_frame(step), curve.size());
+					const size_t end = s.right ? std::clamp(plan.pieces[n + 1].first_frame(step), first, curve.size()) : curve.size();
+					outCurves[n].assign(curve.begin() + first, curve.begin() + end);
+					outSteps[n] = step;
+				}
+			}
+		});
+
+		adoptColumns(out);
+		return plan;
+	}
+
+	std::vector<std::vector<float>> stitch_rows(const split_plan& plan, const std::vector<std::vector<float>>& outputs, float step) {
+		if (!(step > 0.0f)) {
+			throw DsParserError("ƴӽ֡ 0");
+		}
+		if (outputs.size() != plan.pieces.size()) {
+			throw DsParserError("ƴӽзֺ");
+		}
+		std::vector<std::vector<float>> out(plan.rows);
+		for (size_t n = 0; n < plan.pieces.size(); ++n) {
+			const split_piece& piece = plan.pieces[n];
+			if (piece.row >= plan.rows) {
+				throw DsParserError("зֽԭʼгΧ");
+			}
+			// ͬһԭʼеһδһ֡ʼһξ͵һ֡Ϊֹ֮䲻صҲ
+			const bool next = n + 1 < plan.pieces.size() && plan.pieces[n + 1].row == piece.row;
+			const size_t first = piece.first_frame(step);
+			const size_t end = std::max(first, next ? plan.pieces[n + 1].first_frame(step) : piece.end_frame(step));
+			std::vector<float>& row = out[piece.row];
+			if (row.size() < end) row.resize(end, 0.0f);
+			const std::vector<float>& source = outputs[n];
+			if (source.empty()) continue;
+			const size_t copied = std::min(end - first, source.size());
+			std::copy_n(source.begin(), copied, row.begin() + first);
+			std::fill(row.begin() + first + copied, row.begin() + end, source.back());
+		}
+		return out;
+	}
+}
@@ -0,0 +1,222 @@
+#include "DSparser.h"
+
+#include "rapidjson/memorystream.h"
+#include "rapidjson/reader.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+namespace DS {
+	// ʽ DS ı SAX 
+	// ֶ֪εַ/ֱӽ뵽 parser ĸ
+	// ݣδֶ֪ΡͲֶ֪Σԭдÿе _extraJsonǶԭ
+	class stream_handler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, stream_handler> {
+	public:
+		explicit stream_handler(parser& owner)
+			: _owner(owner), _writer(_extraBuffer) {}
+
+		bool Null() { return other([this] { return _writer.Null(); }); }
+		bool Bool(bool b) { return other([&] { return _writer.Bool(b); }); }
+		bool Int(int i) { return number(i, [&] { return _writer.Int(i); }); }
+		bool Uint(unsigned u) { return number(u, [&] { return _writer.Uint(u); }); }
+		bool Int64(int64_t i) { return number(static_cast<double>(i), [&] { return _writer.Int64(i); }); }
+		bool Uint64(uint64_t u) { return number(static_cast<double>(u), [&] { return _writer.Uint64(u); }); }
+		bool Double(double d) { return number(d, [&] { return _writer.Double(d); }); }
+
+		bool String(const char* str, rapidjson::SizeType length, bool) {
+			if (decodable()) {
+				// ֱӶȡ Reader Ļ
+				decode(rapidjson::Value(rapidjson::StringRef(str, length)));
+				return true;
+			}
+			return other([&] { return _writer.String(str, length); });
+		}
+
+		bool Key(const char* str, rapidjson::SizeType length, bool) {
+			if (_capture > 0) return _writer.Key(str, length);
+			_pending = find_field({ str, length });
+			if (_pending == field::unknown) {
+				beginExtra();
+				return _writer.Key(str, length);
+			}
+			return true;
+		}
+
+		bool StartObject() {
+			if (_capture > 0) { ++_capture; return _writer.StartObject(); }
+			switch (_depth) {
+			case 0:
+				throw DsParserError("ȷ DS ʽJSON");
+			case 1:
+				beginRow();
+				_depth = 2;
+				return true;
+			default:
+				beginCapture();
+				return _writer.StartObject();
+			}
+		}
+
+		bool EndObject(rapidjson::SizeType count) {
+			if (_capture > 0) { --_capture; return _writer.EndObject(count); }
+			endRow();
+			_depth = 1;
+			return true;
+		}
+
+		bool StartArray() {
+			if (_capture > 0) { ++_capture; return _writer.StartArray(); }
+			switch (_depth) {
+			case 0:
+				_depth = 1;
+				return true;
+			case 1:
+				// вǶԭ棬ʱһ
+				beginRaw();
+				_capture = 1;
+				return _writer.StartArray();
+			default:
+				beginCapture();
+				return _writer.StartArray();
+			}
+		}
+
+		bool EndArray(rapidjson::SizeType count) {
+			if (_capture > 0) {
+				--_capture;
+				const bool ok = _writer.EndArray(count);
+				if (_capture == 0 && _depth == 1) endRow();
+				return ok;
+			}
+			_depth = 0;
+			return true;
+		}
+
+	private:
+		parser& _owner;
+		rapidjson::StringBuffer _extraBuffer;
+		rapidjson::Writer<rapidjson::StringBuffer> _writer;
+
+		int _depth = 0;					// ڲ㼶1 飬2 ж
+		int _capture = 0;				// ԭǶ
+		bool _hasExtra = false;			// Ҫ
+		bool _raw = false;				// вǶ_extraBuffer еֵ
+		uint32_t _present = 0;			// гֶֹ֪
+		size_t _row = 0;
+		field _pending = field::unknown;// ȴȡֵֶ֪
+
+		// ǰֵǷֱӽ뵽
+		bool decodable() const {
+			return _capture == 0 && _depth == 2 && _pending != field::unknown;
+		}
+
+		void decode(const rapidjson::Value& value) {
+			_present |= field_bit(_pending);
+			_owner.decodeField(_row, _pending, value);
+			_pending = field::unknown;
+		}
+
+		template<typename F>
+		bool number(double value, F&& write) {
+			if (decodable()) {
+				decode(rapidjson::Value(value));
+				return true;
+			}
+			return other(std::forward<F>(write));
+		}
+
+		// ܽ뵽еֵԭ浽е _extraJson
+		template<typename F>
+		bool other(F&& write) {
+			if (_capture > 0) return write();
+			switch (_depth) {
+			case 0:
+				throw DsParserError("ȷ DS ʽJSON");
+			case 1: {
+				// вǶԭֵ
+				beginRaw();
+				const bool ok = write();
+				endRow();
+				return ok;
+			}
+			default:
+				// ֶ֪εͲֶַ֣ͬһ𱣴棬ؽʱԴΪ׼Ӧ
+				if (_pending != field::unknown) {
+					beginExtra();
+					writePendingKey();
+				}
+				return write();
+			}
+		}
+
+		void beginCapture() {
+			if (_pending != field::unknown) {
+				beginExtra();
+				writePendingKey();
+			}
+			_capture = 1;
+		}
+
+		void writePendingKey() {
+			const std::string_view key = field_key(_pending);
+			_present |= field_bit(_pending);
+			_writer.Key(key.data(), static_cast<rapidjson::SizeType>(key.size()));
+			_pending = field::unknown;
+		}
+
+		void beginRow() {
+			_row = _owner._offset.size();
+			_owner.resizeColumns(_row + 1);
+			_pending = field::unknown;
+			_hasExtra = false;
+			_raw = false;
+			_present = 0;
+		}
+
+		void endRow() {
+			_owner._extraJson.resize(_row + 1);
+			if (_hasExtra) {
+				if (!_raw) _writer.EndObject();
+				_owner._extraJson[_row].assign(_extraBuffer.GetString(), _extraBuffer.GetSize());
+				_hasExtra = false;
+			}
+			if (_raw) return;
+			_owner._absent[_row] = ~_present;
+			if (_owner._phNum[_row].empty()) _owner.derivePhNum(_row);
+		}
+
+		void beginRaw() {
+			beginRow();
+			_extraBuffer.Clear();
+			_writer.Reset(_extraBuffer);
+			_hasExtra = true;
+			_raw = true;
+		}
+
+		void beginExtra() {
+			if (_hasExtra) return;
+			_extraBuffer.Clear();
+			_writer.Reset(_extraBuffer);
+			_writer.StartObject();
+			_hasExtra = true;
+		}
+	};
+
+	bool parser::loadStream(const char* json, size_t length) {
+		_dsData.SetArray();
+		_domReady = false;
+
+		stream_handler handler(*this);
+		rapidjson::Reader reader;
+		rapidjson::MemoryStream stream(json, length);
+		if (reader.Parse(stream, handler).IsError()) {
+			//  DOM ʽһ£޷ʱΪ
+			resizeColumns(0);
+			_extraJson.clear();
+			_domReady = true;
+			return false;
+		}
+		_hasData = true;
+		_isLoad = true;
+		return true;
+	}
+}
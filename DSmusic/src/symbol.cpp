@@ -0,0 +1,109 @@
+#include "DSsymbol.h"
+#include "DSparser.h"
+
+#include <mutex>
+
+namespace DS {
+	symbol_table& symbol_table::global() {
+		static symbol_table table;
+		return table;
+	}
+
+	symbol_table::symbol_table() {
+		// ˳ symbols еĹ̶һ
+		intern("SP");
+		intern("AP");
+		intern("rest");
+	}
+
+	symbol symbol_table::intern(std::string_view name) {
+		{
+			std::shared_lock<std::shared_mutex> lock(_mutex);
+			auto it = _ids.find(name);
+			if (it != _ids.end()) return it->second;
+		}
+
+		std::unique_lock<std::shared_mutex> lock(_mutex);
+		auto it = _ids.find(name);
+		if (it != _ids.end()) return it->second; // ڼѱ̵߳Ǽ
+		if (_size == capacity) {
+			throw DsParserError("ű " + std::to_string(capacity) + " ƣ" + std::string(name));
+		}
+
+		const size_t i = _size;
+		auto& chunk = _names[i >> chunk_bits];
+		if (!chunk) {
+			chunk = std::make_unique<std::string[]>(chunk_mask + 1);
+		}
+		std::string& stored = chunk[i & chunk_mask];
+		stored.assign(name);
+
+		uint8_t flags = 0;
+		if (Vowel.count(stored)) flags |= symbol_vowel;
+		if (stored == "SP" || stored == "AP") flags |= symbol_pause;
+		if (stored == "rest") flags |= symbol_rest;
+		_flags[i] = flags;
+
+		const symbol id{ static_cast<uint16_t>(i) };
+		_ids.emplace(stored, id);
+		++_size;
+		return id;
+	}
+
+	lang_table& lang_table::of(const std::string& language) {
+		static std::mutex mutex;
+		static std::unordered_map<std::string, std::unique_ptr<lang_table>> tables;
+		std::lock_guard<std::mutex> lock(mutex);
+		std::unique_ptr<lang_table>& table = tables[language];
+		if (!table) {
+			table.reset(new lang_table(language));
+		}
+		return *table;
+	}
+
+	lang_table::lang_table(const std::string& language)
+		: _prefix(language + "/")
+	{
+	}
+
+	symbol lang_table::map(symbol ph) {
+		// ߳ͬʱ״λͬһʱԵǼǣintern ֤õͬһ
+		std::atomic<uint32_t>& slot = _ids[static_cast<size_t>(ph)];
+		uint32_t id = slot.load(std::memory_order_relaxed);
+		if (id == 0) {
+			std::string name = _prefix;
+			name += symbol_name(ph);
+			id = static_cast<uint32_t>(intern_symbol(name)) + 1;
+			slot.store(id, std::memory_order_relaxed);
+		}
+		return static_cast<symbol>(id - 1);
+	}
+
+	symbol intern_symbol(std::string_view name) {
+		return symbol_table::global().intern(name);
+	}
+
+	std::string_view symbol_name(symbol id) {
+		return symbol_table::global().name(id);
+	}
+
+	std::vector<symbol> intern_symbols(const std::vector<std::string>& names) {
+		symbol_table& table = symbol_table::global();
+		std::vector<symbol> out;
+		out.reserve(names.size());
+		for (const std::string& name : names) {
+			out.push_back(table.intern(name));
+		}
+		return out;
+	}
+
+	std::vector<std::string> symbol_names(const std::vector<symbol>& ids) {
+		const symbol_table& table = symbol_table::global();
+		std::vector<std::string> out;
+		out.reserve(ids.size());
+		for (symbol id : ids) {
+			out.emplace_back(table.name(id));
+		}
+		return out;
+	}
+}
@@ -0,0 +1,204 @@
+#include "DSview.h"
+
+#include <ostream>
+
+namespace DS {
+	row_view::row_view(std::shared_ptr<const parser> store, size_t row)
+		: _store(std::move(store)), _row(row)
+	{
+	}
+
+	int row_view::at(int row) const {
+		if (_own) return row;
+		if (row != 0) {
+			throw std::out_of_range("row_view: row out of range");
+		}
+		return static_cast<int>(_row);
+	}
+
+	parser& row_view::own() {
+		if (!_own) {
+			_own = std::make_unique<parser>(*_store, _row, 1);
+			_store.reset();
+		}
+		return *_own;
+	}
+
+	std::unique_ptr<parser> row_view::detached() const {
+		return std::make_unique<parser>(*_store, _row, 1);
+	}
+
+	void row_view::pack(float time_s, float maxInterval_s, const pack_options& options) {
+		own().pack(time_s, maxInterval_s, options);
+	}
+
+	std::vector<std::string> row_view::pack(
+		float time_s,
+		float maxInterval_s,
+		const std::vector<std::string>& word_seq,
+		const pack_options& options
+	){
+		return own().pack(time_s, maxInterval_s, word_seq, options);
+	}
+
+	pack_plan row_view::planPack(float time_s, float maxInterval_s, const pack_cost& cost) const {
+		return _own ? _own->planPack(time_s, maxInterval_s, cost) : detached()->planPack(time_s, maxInterval_s, cost);
+	}
+
+	pack_plan row_view::planPackBalanced(double budget, float maxInterval_s, const pack_cost& cost) const {
+		return _own ? _own->planPackBalanced(budget, maxInterval_s, cost) : detached()->planPackBalanced(budget, maxInterval_s, cost);
+	}
+
+	void row_view::pack(const pack_plan& plan, const pack_options& options) {
+		own().pack(plan, options);
+	}
+
+	std::vector<std::string> row_view::pack(
+		const pack_plan& plan,
+		const std::vector<std::string>& word_seq,
+		const pack_options& options
+	){
+		return own().pack(plan, word_seq, options);
+	}
+
+	std::unique_ptr<music> row_view::packed(const pack_plan& plan, const pack_options& options) const {
+		return _own ? _own->packed(plan, options) : detached()->packed(plan, options);
+	}
+
+	void row_view::scatter(
+		const pack_plan& plan,
+		curve_type type,
+		const std::vector<std::vector<float>>& outputs,
+		float step
+	){
+		own().scatter(plan, type, outputs, step);
+	}
+
+	std::vector<std::unique_ptr<music>> row_view::split() {
+		if (_own) return _own->split();
+		// ֻһУٸһָͬһеͼ
+		std::vector<std::unique_ptr<music>> out;
+		out.push_back(std::make_unique<row_view>(_store, _row));
+		return out;
+	}
+
+	split_plan row_view::splitLongRows(float max_s, bool prefer_breaks) {
+		return own().splitLongRows(max_s, prefer_breaks);
+	}
+
+	bool row_view::set(
+		const std::vector<std::string>& note_seq,
+		const std::vector<float>& note_dur,
+		const std::vector<int>& note_slur,
+		const std::vector<std::string>& ph_seq,
+		const std::vector<float>& ph_dur,
+		float offset,
+		int row
+	){
+		return own().set(note_seq, note_dur, note_slur, ph_seq, ph_dur, offset, row);
+	}
+
+	bool row_view::set(
+		const std::vector<std::string>& note_seq,
+		const std::vector<float>& note_dur,
+		const std::vector<int>& note_slur,
+		float offset,
+		int row
+	){
+		return own().set(note_seq, note_dur, note_slur, offset, row);
+	}
+
+	bool row_view::set_lyrics(
+		const std::vector<std::string>& ph_seq,
+		const std::vector<float>& ph_dur,
+		int row
+	){
+		return own().set_lyrics(ph_seq, ph_dur, row);
+	}
+
+	std::string row_view::get() const {
+		return _own ? _own->get() : detached()->get();
+	}
+
+	void row_view::write(std::string& out, const write_options& options) const {
+		if (_own) {
+			_own->write(out, options);
+			return;
+		}
+		// ֻһеĶֱͬɹ
+		out += '[';
+		_store->writeRow(out, _row, options.precision);
+		out += ']';
+	}
+
+	void row_view::write(std::ostream& out, const write_options& options) const {
+		std::string buffer;
+		write(buffer, options);
+		out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+	}
+
+	std::string row_view::getBinary() const {
+		return _own ? _own->getBinary() : detached()->getBinary();
+	}
+
+	std::vector<float> row_view::getOffset() const {
+		if (_own) return _own->getOffset();
+		return { _store->getOffset(static_cast<int>(_row)) };
+	}
+
+	std::span<const float> row_view::viewOffset() const {
+		if (_own) return _own->viewOffset();
+		return _store->viewOffset().subspan(_row, 1);
+	}
+
+	std::vector<std::vector<float>> row_view::getCurveStep(curve_type type, float step, interp_mode mode) const {
+		if (_own) return _own->getCurveStep(type, step, mode);
+		std::vector<std::vector<float>> out;
+		out.push_back(getCurveStep(type, 0, step, mode));
+		return out;
+	}
+
+	std::vector<std::array<std::vector<float>, curve_count>> row_view::getCurvesStep(float step, interp_mode mode) const {
+		if (_own) return _own->getCurvesStep(step, mode);
+		std::vector<std::array<std::vector<float>, curve_count>> out(1);
+		for (size_t c = 0; c < curve_count; ++c) {
+			out[0][c] = getCurveStep(static_cast<curve_type>(c), 0, step, mode);
+		}
+		return out;
+	}
+
+	row_view& row_view::setPitch(std::vector<float> data, float offset, int row) {
+		own().setPitch(std::move(data), offset, row);
+		return *this;
+	}
+
+	row_view& row_view::setPhTime(std::vector<float> data, float offset, int row) {
+		own().setPhTime(std::move(data), offset, row);
+		return *this;
+	}
+
+	row_view& row_view::setEnergy(std::vector<float> data, float offset, int row) {
+		own().setEnergy(std::move(data), offset, row);
+		return *this;
+	}
+
+	row_view& row_view::setBreathiness(std::vector<float> data, float offset, int row) {
+		own().setBreathiness(std::move(data), offset, row);
+		return *this;
+	}
+
+	row_view& row_view::setVoicing(std::vector<float> data, float offset, int row) {
+		own().setVoicing(std::move(data), offset, row);
+		return *this;
+	}
+
+	row_view& row_view::setTension(std::vector<float> data, float offset, int row) {
+		own().setTension(std::move(data), offset, row);
+		return *this;
+	}
+
+	row_view& row_view::setMouthOpening(std::vector<float> data, float offset, int row) {
+		own().setMouthOpening(std::move(data), offset, row);
+		return *this;
+	}
+}
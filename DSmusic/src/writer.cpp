@@ -0,0 +1,246 @@
+#include "DSparser.h"
+
+#include "rapidjson/internal/dtoa.h"
+#include "rapidjson/ostreamwrapper.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+
+namespace DS {
+	namespace {
+		constexpr double pow10[] = { 1.0, 10.0, 100.0, 1000.0, 1e4, 1e5, 1e6 };
+
+		// 0 <= x < 2^52 ʱͽȡȡż nearbyint ͬÿ⺯
+		// ϸĸ壬 -ffast-math/fp:fast ±
+		inline double round_even(double x) {
+			constexpr double magic = 4503599627370496.0;	// 2^52
+			return (x + magic) - magic;
+		}
+
+		// Ǹ digits  decimals λСdigits = ֵ * 10^decimalsʡĩβ 0
+		void append_scaled(std::string& out, bool negative, uint64_t digits, int decimals) {
+			while (decimals > 0 && digits % 10 == 0) {
+				digits /= 10;
+				--decimals;
+			}
+			char buf[32];
+			char* p = buf + sizeof(buf);
+			for (int i = 0; i < decimals; ++i) {
+				*--p = static_cast<char>('0' + digits % 10);
+				digits /= 10;
+			}
+			if (decimals > 0) *--p = '.';
+			do {
+				*--p = static_cast<char>('0' + digits % 10);
+				digits /= 10;
+			} while (digits != 0);
+			if (negative) *--p = '-';
+			out.append(p, buf + sizeof(buf));
+		}
+
+		// ҿɾȷصıʾ std::to_chars(value) ͬ
+		// DS еʱߴֻмλСγ 0~3 λСĺѡܶԭֵʱֱ
+		// Χ value * 10^d ѡֵĻ double жǾȷģҶдڿѧ
+		void append_number(std::string& out, float value) {
+			const double v = value;
+			const double magnitude = v < 0.0 ? -v : v;
+			if (magnitude < 1e5 && value == value) {
+				for (int d = 0; d <= 3; ++d) {
+					const double scaled = round_even(magnitude * pow10[d]);
+					if (static_cast<float>(scaled / pow10[d]) == static_cast<float>(magnitude)) {
+						append_scaled(out, std::signbit(value), static_cast<uint64_t>(scaled), d);
+						return;
+					}
+				}
+			}
+			char buf[32];
+			auto result = std::to_chars(buf, buf + sizeof(buf), value);
+			out.append(buf, result.ptr);
+		}
+
+		// ƫʱ䣺 buildDom  DOM ֵдͬ 0.01.5write()  get() һ
+		void append_scalar(std::string& out, float value) {
+			if (!std::isfinite(value)) {
+				append_number(out, value);
+				return;
+			}
+			char buf[32];
+			char* end = rapidjson::internal::dtoa(widen(value), buf);
+			out.append(buf, end);
+		}
+
+		//  precision λСʡĩβ 0 С㣬-0 д 0
+		void append_fixed(std::string& out, float value, int precision) {
+			const double v = value;
+			const double magnitude = v < 0.0 ? -v : v;
+			if (precision <= 6 && magnitude < 1e9) {
+				// 24 λβ 10^6  double ľڣ뷽ʽ to_chars ͬͽȡż
+				const double scaled = round_even(magnitude * pow10[precision]);
+				append_scaled(out, v < 0.0 && scaled != 0.0, static_cast<uint64_t>(scaled), precision);
+				return;
+			}
+
+			char buf[64];
+			auto result = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::fixed, precision);
+			if (result.ec != std::errc()) {
+				append_number(out, value);
+				return;
+			}
+			char* end = result.ptr;
+			if (precision > 0) {
+				while (end[-1] == '0') --end;
+				if (end[-1] == '.') --end;
+			}
+			if (end - buf == 2 && buf[0] == '-' && buf[1] == '0') {
+				out += '0';
+				return;
+			}
+			out.append(buf, end);
+		}
+
+		void append_value(std::string& out, int value, int) {
+			char buf[16];
+			auto result = std::to_chars(buf, buf + sizeof(buf), value);
+			out.append(buf, result.ptr);
+		}
+
+		void append_value(std::string& out, float value, int precision) {
+			if (precision < 0) append_number(out, value);
+			else append_fixed(out, value, precision);
+		}
+
+		// еšбַҪת壬ֽڣ UTF-8ԭ
+		void append_value(std::string& out, symbol value, int) {
+			const std::string_view name = symbol_name(value);
+			for (char c : name) {
+				const unsigned char u = static_cast<unsigned char>(c);
+				if (c == '"' || c == '\\') {
+					out += '\\';
+					out += c;
+				}
+				else if (u < 0x20) {
+					constexpr char hex[] = "0123456789ABCDEF";
+					out += "\\u00";
+					out += hex[u >> 4];
+					out += hex[u & 0xF];
+				}
+				else {
+					out += c;
+				}
+			}
+		}
+
+		void append_key(std::string& out, field f, bool& first) {
+			if (!first) out += ',';
+			first = false;
+			out += '"';
+			out += field_key(f);
+			out += "\":";
+		}
+	}
+
+	void parser::writeRow(std::string& out, size_t row, int precision) const {
+		// δֶ֪ηǰ buildDom һ£бԭֵֶ֪β
+		const std::string extra = extraJson(row);
+		if (!extra.empty() && extra.front() != '{') {
+			// ԭвǶУԭ
+			out += extra;
+			return;
+		}
+		out += '{';
+		bool first = true;
+
+		// ԭûеֶΣ ph_seq ֳ ph_numͬ
+		uint32_t held = absentFields(row);
+		if (extra.size() > 2) {
+			out.append(extra, 1, extra.size() - 2);
+			first = false;
+			held |= extraFields(extra);
+		}
+
+		forEachColumn(*this, [&](field f, const auto& column) {
+			if (row >= column.size() || (held & field_bit(f))) return;
+			if constexpr (std::is_same_v<std::decay_t<decltype(column)>, std::vector<float>>) {
+				// offset ʱδã<= 0ʱ
+				if (f != field::offset && column[row] <= 0.0f) return;
+				append_key(out, f, first);
+				append_scalar(out, column[row]);
+			}
+			else {
+				// УյĲԪ֮Կոֱָд outʱַ
+				if (column[row].empty()) return;
+				append_key(out, f, first);
+				out += '"';
+				bool head = true;
+				for (const auto& value : column[row]) {
+					if (!head) out += ' ';
+					head = false;
+					append_value(out, value, precision);
+				}
+				out += '"';
+			}
+		});
+
+		out += '}';
+	}
+
+	void parser::write(std::string& out, const write_options& options) const {
+		if (!_isLoad.load(std::memory_order_acquire)) {
+			const_cast<parser*>(this)->load();
+		}
+
+		//  DOM ʱ DOM  get() һԭĵֶ˳ֵд
+		if (_domReady && options.precision < 0) {
+			rapidjson::StringBuffer buffer;
+			rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+			dom().Accept(writer);
+			out.append(buffer.GetString(), buffer.GetSize());
+			return;
+		}
+
+		// ȰÿֵԼ 8 ֽԤ⼸ʮ MB з
+		const size_t rows = _offset.size();
+		size_t values = 0;
+		for (size_t row = 0; row < rows; ++row) {
+			for (const auto* column : { &_f0_seq, &_energy, &_breathiness, &_voicing, &_tension, &_mouthOpening, &_phTime, &_noteTime }) {
+				if (row < column->size()) values += (*column)[row].size();
+			}
+		}
+		out.reserve(out.size() + values * 8 + rows * 256);
+		out += '[';
+		for (size_t row = 0; row < rows; ++row) {
+			if (row != 0) out += ',';
+			writeRow(out, row, options.precision);
+		}
+		out += ']';
+	}
+
+	void parser::write(std::ostream& out, const write_options& options) const {
+		if (!_isLoad.load(std::memory_order_acquire)) {
+			const_cast<parser*>(this)->load();
+		}
+
+		if (_domReady && options.precision < 0) {
+			rapidjson::OStreamWrapper stream(out);
+			rapidjson::Writer<rapidjson::OStreamWrapper> writer(stream);
+			dom().Accept(writer);
+			return;
+		}
+
+		// ɵͬһдм临
+		const size_t rows = _offset.size();
+		std::string buffer;
+		out.put('[');
+		for (size_t row = 0; row < rows; ++row) {
+			buffer.clear();
+			if (row != 0) buffer += ',';
+			writeRow(buffer, row, options.precision);
+			out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+		}
+		out.put(']');
+	}
+}
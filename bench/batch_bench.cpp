@@ -0,0 +1,117 @@
+// ܲԣϳ 8 ׸裬ÿ 250 Уÿ 1~15 벻ȣ f0 ߣ
+// ԱȰԭ˳ÿ B һе getMidiStepgetPhDur ֹ䣩 make_batches Ͱʱ
+#include "DSmusic.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+	std::string make_song(std::mt19937& rng) {
+		std::uniform_int_distribution<int> notes(2, 30);
+		std::string ds = "[";
+		char buf[64];
+		double offset = 0.0;
+		for (int row = 0; row < 250; ++row) {
+			const int count = notes(rng);		// ÿ 0.5 룬һһԪ
+			std::string ph_seq, ph_dur, note_seq, note_dur, note_slur, f0;
+			for (int n = 0; n < count; ++n) {
+				const char* sep = n == 0 ? "" : " ";
+				ph_seq += sep; ph_seq += "n a";
+				ph_dur += sep; ph_dur += "0.1 0.4";
+				note_seq += sep; note_seq += "C4";
+				note_dur += sep; note_dur += "0.5";
+				note_slur += sep; note_slur += "0";
+			}
+			for (int k = 0; k < count * 100; ++k) {
+				std::snprintf(buf, sizeof(buf), "%s%.1f", k == 0 ? "" : " ", 261.6 + k % 10);
+				f0 += buf;
+			}
+			std::snprintf(buf, sizeof(buf), "%.3f", offset);
+			if (row != 0) ds += ',';
+			ds += "{\"offset\":" + std::string(buf) + ",\"ph_seq\":\"" + ph_seq + "\",\"ph_dur\":\"" + ph_dur
+				+ "\",\"note_seq\":\"" + note_seq + "\",\"note_dur\":\"" + note_dur + "\",\"note_slur\":\"" + note_slur
+				+ "\",\"f0_seq\":\"" + f0 + "\",\"f0_timestep\":0.005}";
+			offset += count * 0.5 + 1.0;
+		}
+		ds += "]";
+		return ds;
+	}
+
+	// ԭ˳ÿ B һ䵽һ
+	double naive(const std::vector<const DS::music*>& songs, size_t B, float step, double& padding) {
+		auto start = std::chrono::steady_clock::now();
+		std::vector<std::pair<const DS::music*, int>> rows;
+		for (const DS::music* song : songs) {
+			for (int row = 0; row < song->getRowCount(); ++row) rows.emplace_back(song, row);
+		}
+		size_t valid = 0, padded = 0;
+		for (size_t i = 0; i < rows.size(); i += B) {
+			const size_t end = std::min(rows.size(), i + B);
+			size_t T = 0, T_ph = 0;
+			for (size_t j = i; j < end; ++j) {
+				T = std::max(T, rows[j].first->getMidiStep(rows[j].second, step).size());
+				T_ph = std::max(T_ph, rows[j].first->getPhDur(rows[j].second).size());
+			}
+			std::vector<float> midi((end - i) * T, 0.0f), dur((end - i) * T_ph, 0.0f), f0((end - i) * T, 0.0f);
+			for (size_t j = i; j < end; ++j) {
+				const auto& m = rows[j].first->getMidiStep(rows[j].second, step);
+				const auto& d = rows[j].first->getPhDur(rows[j].second);
+				const auto p = rows[j].first->getCurveStep(DS::curve_type::f0, rows[j].second, step);
+				std::copy(m.begin(), m.end(), midi.begin() + (j - i) * T);
+				std::copy(d.begin(), d.end(), dur.begin() + (j - i) * T_ph);
+				std::copy_n(p.begin(), std::min(p.size(), m.size()), f0.begin() + (j - i) * T);
+				valid += m.size();
+			}
+			padded += (end - i) * T;
+		}
+		padding = 1.0 - static_cast<double>(valid) / static_cast<double>(padded);
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	double bucketed(const std::vector<const DS::music*>& songs, size_t B, float step, double& padding, size_t& batches) {
+		auto start = std::chrono::steady_clock::now();
+		DS::batch_options options;
+		options.step = step;
+		options.max_rows = B;
+		const auto out = DS::make_batches(songs, options);
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		size_t valid = 0, padded = 0;
+		for (const auto& batch : out) {
+			for (int64_t length : batch.frame_length) valid += static_cast<size_t>(length);
+			padded += batch.rows * batch.frames;
+		}
+		padding = 1.0 - static_cast<double>(valid) / static_cast<double>(padded);
+		batches = out.size();
+		return seconds;
+	}
+}
+
+int main() {
+	std::mt19937 rng(1);
+	std::vector<std::unique_ptr<DS::music>> owned;
+	std::vector<const DS::music*> songs;
+	for (int i = 0; i < 8; ++i) {
+		owned.emplace_back(DS::get_music(make_song(rng), "zh", DS::load_mode::stream));
+		songs.push_back(owned.back().get());
+	}
+	const float step = 512.0f / 44100.0f;
+	// ȸһΣʹ getMidiStep Ļͬ
+	double padding = 0.0;
+	size_t batches = 0;
+	naive(songs, 16, step, padding);
+	bucketed(songs, 16, step, padding, batches);
+
+	std::printf("%6s %14s %10s %14s %10s %8s\n", "B", "in order pad", "ms", "bucketed pad", "ms", "batches");
+	for (size_t B : { 4, 8, 16, 32, 64 }) {
+		double a = 0.0, b = 0.0;
+		const double ta = naive(songs, B, step, a);
+		const double tb = bucketed(songs, B, step, b, batches);
+		std::printf("%6zu %13.1f%% %10.2f %13.1f%% %10.2f %8zu\n", B, a * 100, ta * 1e3, b * 100, tb * 1e3, batches);
+	}
+	return 0;
+}
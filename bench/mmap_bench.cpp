@@ -0,0 +1,188 @@
+// ļܲԣȶַٽ Ա ڴӳֱӽ Ա  DS
+// ÿַʽֱҳ棨Ȱļϵͳ棩ҳĺʱ
+// ʱǰȷ DS ı DS ֶβ䣬δ޸ĵĵ write()  get() ͬ
+// ÷mmap_bench [file.ds]ָļʱһϳɵ DS ļ
+#include <DSmusic.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	// ļϵͳҳ
+	// Windows ޻巽ʽļʹ仺ʧЧPOSIX ʹ posix_fadvise
+	bool evict(const std::string& path) {
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		CloseHandle(file);
+		return true;
+#else
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+		bool ok = ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+		::close(fd);
+		return ok;
+#endif
+	}
+
+	std::string make_sample(const std::string& path) {
+		std::mt19937 rng(7);
+		std::uniform_real_distribution<float> hz(80.0f, 800.0f);
+		std::ofstream out(path, std::ios::binary);
+		out << "[";
+		for (int row = 0; row < 200; ++row) {
+			if (row != 0) out << ",";
+			// ph_num  ph_seq ƶϵĻֲͬһû offsetڼʧ
+			out << "{";
+			if (row != 199) out << "\"offset\":" << row * 12.0 << ",";
+			out << "\"ph_seq\":\"SP a i SP\",\"ph_num\":\"1 2 1\",\"ph_dur\":\"0.5 4 6 1.5\","
+				<< "\"note_seq\":\"rest C4 D4 rest\",\"note_dur\":\"0.5 4 6 1.5\",\"note_slur\":\"0 0 0 0\","
+				<< "\"f0_timestep\":0.005,\"f0_seq\":\"";
+			for (int i = 0; i < 24000; ++i) out << (i ? " " : "") << hz(rng);
+			out << "\"}";
+		}
+		out << "]";
+		return path;
+	}
+
+	std::string read_file(const std::string& path) {
+		std::ifstream in(path, std::ios::binary);
+		std::stringstream buffer;
+		buffer << in.rdbuf();
+		return buffer.str();
+	}
+
+	template<typename T>
+	bool same(std::span<const T> a, std::span<const T> b) {
+		return std::equal(a.begin(), a.end(), b.begin(), b.end());
+	}
+
+	size_t count_key(const std::string& json, const std::string& key) {
+		size_t n = 0;
+		for (size_t at = json.find(key); at != std::string::npos; at = json.find(key, at + key.size())) ++n;
+		return n;
+	}
+
+	// бȽĸֶΣصһͬУȫͬʱ -1
+	int first_mismatch(const DS::music& a, const DS::music& b) {
+		if (a.getRowCount() != b.getRowCount()) return 0;
+		for (int row = 0; row < a.getRowCount(); ++row) {
+			bool ok = same(a.viewPhSeq(row), b.viewPhSeq(row))
+				&& same(a.viewPhNum(row), b.viewPhNum(row))
+				&& same(a.viewPhDur(row), b.viewPhDur(row))
+				&& same(a.viewNoteSeq(row), b.viewNoteSeq(row))
+				&& same(a.viewNoteTime(row), b.viewNoteTime(row))
+				&& same(a.viewNoteSlur(row), b.viewNoteSlur(row))
+				&& a.getOffset(row) == b.getOffset(row)
+				&& a.getTickTime(row) == b.getTickTime(row);
+			for (size_t c = 0; ok && c < DS::curve_count; ++c) {
+				const auto type = static_cast<DS::curve_type>(c);
+				ok = same(a.viewCurve(type, row), b.viewCurve(type, row));
+			}
+			if (!ok) return row;
+		}
+		return -1;
+	}
+
+	template<typename F>
+	double measure(F&& load) {
+		auto start = std::chrono::steady_clock::now();
+		std::unique_ptr<DS::music> song(load());
+		song->load();
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	}
+
+	template<typename F>
+	void run(const char* name, const std::string& path, F&& load) {
+		bool evicted = evict(path);
+		double cold = measure(load);
+		double warm = measure(load);
+		std::printf("%-26s cold %9.1f ms%s   warm %9.1f ms\n", name, cold, evicted ? "" : "(?)", warm);
+	}
+}
+
+int main(int argc, char** argv) {
+	std::string path = argc > 1 ? argv[1] : make_sample("mmap_bench_sample.ds");
+
+	// ȷ϶ DS ıκֶΣֱӶȡתص DS ıӦԭһ
+	{
+		const std::string text = read_file(path);
+		const std::string data = DS::ds_to_binary(text);
+		const std::string back = DS::binary_to_ds(data);
+		std::unique_ptr<DS::music> source(DS::get_music(text, "zh"));
+		std::unique_ptr<DS::music> binary(DS::get_music_from_binary(data, "zh"));
+		std::unique_ptr<DS::music> reparsed(DS::get_music(back, "zh"));
+		source->load();
+		reparsed->load();
+		int row = first_mismatch(*source, *binary);
+		if (row < 0) row = first_mismatch(*source, *reparsed);
+		if (row >= 0) {
+			std::printf("binary round trip mismatch at row %d\n", row);
+			return 1;
+		}
+		for (const char* key : { "\"offset\"", "\"ph_num\"" }) {
+			if (count_key(text, key) != count_key(back, key)) {
+				std::printf("binary round trip mismatch: %s appears %zu -> %zu times\n",
+					key, count_key(text, key), count_key(back, key));
+				return 1;
+			}
+		}
+
+		//  write()  get()ʽƼʱ write() ɸɣܽ get() õ DOM
+		const DS::load_mode modes[] = { DS::load_mode::dom, DS::load_mode::lazy, DS::load_mode::stream };
+		const char* names[] = { "dom", "lazy", "stream" };
+		for (size_t i = 0; i <= std::size(modes); ++i) {
+			std::unique_ptr<DS::music> song(i < std::size(modes)
+				? DS::get_music(text, "zh", modes[i])
+				: DS::get_music_from_binary(data, "zh"));
+			song->load();
+			std::string written;
+			song->write(written);
+			if (written != song->get()) {
+				std::printf("write() and get() differ (%s)\n", i < std::size(modes) ? names[i] : "binary");
+				return 1;
+			}
+		}
+	}
+
+	run("read + get_music (dom)", path, [&] {
+		return DS::get_music(read_file(path), "zh");
+	});
+	run("mmap dom (insitu)", path, [&] {
+		return DS::get_music_from_file(path, "zh", DS::load_mode::dom);
+	});
+	run("read + get_music (stream)", path, [&] {
+		return DS::get_music(read_file(path), "zh", DS::load_mode::stream);
+	});
+	run("mmap stream", path, [&] {
+		return DS::get_music_from_file(path, "zh", DS::load_mode::stream);
+	});
+
+	// תһζ DS֮ļֻ追
+	std::string binary = path + ".dsb";
+	std::ofstream(binary, std::ios::binary) << DS::ds_to_binary(read_file(path));
+	run("mmap binary", binary, [&] {
+		return DS::get_music_from_file(binary, "zh");
+	});
+	return 0;
+}
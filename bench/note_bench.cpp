@@ -0,0 +1,113 @@
+// ܲԣɵ std::map + substr + stoi · Ա note_to_midi
+// ÿַʽ Mnotes/s
+#include "DSnote.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+	// ʵ֣ÿ substrһ map ҡһ stoi
+	float legacy_note_to_midi(const std::string& noteName) {
+		static std::map<std::string, int> noteMap = {
+			{"C", 0}, {"C#", 1}, {"Db", 1},
+			{"D", 2}, {"D#", 3}, {"Eb", 3},
+			{"E", 4}, {"Fb", 4}, {"E#", 5},
+			{"F", 5}, {"F#", 6}, {"Gb", 6},
+			{"G", 7}, {"G#", 8}, {"Ab", 8},
+			{"A", 9}, {"A#", 10}, {"Bb", 10},
+			{"B", 11}, {"Cb", 11}, {"B#", 0}
+		};
+
+		size_t i = 0;
+		while (i < noteName.size() && (noteName[i] < '0' || noteName[i] > '9') && noteName[i] != '-') {
+			++i;
+		}
+		std::string notePart = noteName.substr(0, i);
+		std::string octavePart = noteName.substr(i);
+
+		auto it = noteMap.find(notePart);
+		if (it == noteMap.end()) {
+			throw std::invalid_argument("Invalid note name: " + noteName);
+		}
+		return static_cast<float>((std::stoi(octavePart) + 1) * 12 + it->second);
+	}
+
+	template<typename F>
+	double measure(F&& f, int repeat) {
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < repeat; ++i) f();
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double>(end - start).count();
+	}
+}
+
+int main() {
+	constexpr size_t count = 100000;	// Լһ 5ms ز֡
+	constexpr int repeat = 50;
+
+	const char* pitches[] = {
+		"C", "C#", "Db", "D", "D#", "Eb", "E", "Fb", "E#", "F", "F#",
+		"Gb", "G", "G#", "Ab", "A", "A#", "Bb", "B", "Cb", "B#"
+	};
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<int> pitch(0, 20);
+	std::uniform_int_distribution<int> octave(-1, 8);
+
+	std::vector<std::string> names(count);
+	for (auto& name : names) {
+		name = std::string(pitches[pitch(rng)]) + std::to_string(octave(rng));
+	}
+	std::vector<std::string_view> views(names.begin(), names.end());
+
+	// ȷʵֽһ
+	for (const auto& name : names) {
+		if (legacy_note_to_midi(name) != static_cast<float>(DS::note_to_midi(name))) {
+			std::printf("mismatch: %s\n", name.c_str());
+			return 1;
+		}
+	}
+
+	long long sink = 0;
+	double legacy = measure([&] {
+		for (const auto& name : names) sink += static_cast<long long>(legacy_note_to_midi(name));
+	}, repeat);
+	double single = measure([&] {
+		for (auto name : views) sink += DS::note_to_midi(name);
+	}, repeat);
+	std::vector<int> out(count);
+	double batch = measure([&] {
+		DS::note_to_midi(views, out);
+		sink += out[count / 2];
+	}, repeat);
+
+	// ֡زУÿظԼ 100 ָ֡֡ͬһ
+	std::vector<std::string_view> frames;
+	frames.reserve(count);
+	for (size_t i = 0; frames.size() < count; ++i) {
+		frames.insert(frames.end(), std::min<size_t>(100, count - frames.size()), views[i]);
+	}
+	std::vector<std::string> frameNames(frames.begin(), frames.end());
+	double legacyFrames = measure([&] {
+		for (const auto& name : frameNames) sink += static_cast<long long>(legacy_note_to_midi(name));
+	}, repeat);
+	double batchFrames = measure([&] {
+		DS::note_to_midi(frames, out);
+		sink += out[count / 2];
+	}, repeat);
+
+	double total = static_cast<double>(count) * repeat;
+	std::printf("random names\n");
+	std::printf("  legacy  %10.2f Mnotes/s\n", total / legacy / 1e6);
+	std::printf("  single  %10.2f Mnotes/s   x%.1f\n", total / single / 1e6, legacy / single);
+	std::printf("  batch   %10.2f Mnotes/s   x%.1f\n", total / batch / 1e6, legacy / batch);
+	std::printf("resampled frames\n");
+	std::printf("  legacy  %10.2f Mnotes/s\n", total / legacyFrames / 1e6);
+	std::printf("  batch   %10.2f Mnotes/s   x%.1f   (%lld)\n", total / batchFrames / 1e6, legacyFrames / batchFrames, sink);
+	return 0;
+}
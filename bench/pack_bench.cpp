@@ -0,0 +1,58 @@
+// ܲԣϳ N ж־䣨ÿ 0.5 롢4 ء2 м 0.1 룩
+// ֱһУtime_s ޣ 10 һУʱÿкʱ
+// ÿкʱ N Ϊ
+#include "DSmusic.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+	std::string make_song(size_t rows) {
+		std::string ds = "[";
+		char offset[32];
+		for (size_t row = 0; row < rows; ++row) {
+			std::snprintf(offset, sizeof(offset), "%.3f", row * 0.6);
+			if (row != 0) ds += ',';
+			ds += "{\"offset\":";
+			ds += offset;
+			ds += ",\"ph_seq\":\"SP n i h ao\",\"ph_dur\":\"0.1 0.05 0.1 0.05 0.2\",\"ph_num\":\"2 2 1\""
+				",\"note_seq\":\"rest C4 D4\",\"note_dur\":\"0.1 0.15 0.25\",\"note_slur\":\"0 0 0\""
+				",\"f0_seq\":\"261.6 261.6 261.6 261.6 261.6 261.6 261.6 261.6 261.6 261.6\",\"f0_timestep\":0.05}";
+		}
+		ds += "]";
+		return ds;
+	}
+
+	// ÿδ½Ķֻƴʱ
+	double measure(const std::string& ds, float time_s, int repeat, size_t& packed) {
+		double total = 0.0;
+		for (int i = 0; i < repeat; ++i) {
+			std::unique_ptr<DS::music> song(DS::get_music(ds, "zh", DS::load_mode::stream));
+			song->load();
+			auto start = std::chrono::steady_clock::now();
+			song->pack(time_s, 1.0f);
+			auto end = std::chrono::steady_clock::now();
+			total += std::chrono::duration<double>(end - start).count();
+			packed = song->getRowCount();
+		}
+		return total / repeat;
+	}
+}
+
+int main() {
+	constexpr int repeat = 5;
+	std::printf("%8s %10s %12s %12s %10s %12s %12s\n",
+		"rows", "one row", "ms", "ns/row", "10 s rows", "ms", "ns/row");
+	for (size_t rows : { 1250, 2500, 5000, 10000, 20000 }) {
+		const std::string ds = make_song(rows);
+		size_t whole = 0, windowed = 0;
+		const double a = measure(ds, 1e9f, repeat, whole);
+		const double b = measure(ds, 10.0f, repeat, windowed);
+		std::printf("%8zu %10zu %12.2f %12.1f %10zu %12.2f %12.1f\n",
+			rows, whole, a * 1e3, a * 1e9 / rows, windowed, b * 1e3, b * 1e9 / rows);
+	}
+	return 0;
+}
@@ -0,0 +1,85 @@
+// ִܲԣɵ split_str + istringstream · Ա from_chars ִ
+// ÿԪ͵ tokens/s
+#include "DStokenizer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+	// ʵ֣ȿз֡ÿ token һ istringstream
+	std::vector<std::string> legacy_split(const std::string& str, char delimiter) {
+		std::vector<std::string> tokens;
+		std::stringstream ss(str);
+		std::string token;
+		while (std::getline(ss, token, delimiter)) {
+			tokens.push_back(token);
+		}
+		return tokens;
+	}
+
+	template<typename T>
+	std::vector<T> legacy_parse(const char* str) {
+		std::string valueStr = str;
+		std::vector<T> result;
+		for (const auto& item : legacy_split(valueStr, ' ')) {
+			std::istringstream iss(item);
+			T convertedValue;
+			iss >> convertedValue;
+			if (iss.fail()) continue;
+			result.push_back(convertedValue);
+		}
+		return result;
+	}
+
+	template<typename F>
+	double measure(F&& f, int repeat) {
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < repeat; ++i) f();
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double>(end - start).count();
+	}
+
+	template<typename T>
+	void run(const char* name, const std::string& text, size_t tokens, int repeat) {
+		size_t sink = 0;
+		double legacy = measure([&] { sink += legacy_parse<T>(text.c_str()).size(); }, repeat);
+		double fast = measure([&] {
+			sink += DS::tokenize<T>(text.data(), text.data() + text.size()).size();
+		}, repeat);
+
+		double total = static_cast<double>(tokens) * repeat;
+		std::printf("%-8s legacy %10.2f Mtok/s   from_chars %10.2f Mtok/s   x%.1f   (%zu)\n",
+			name, total / legacy / 1e6, total / fast / 1e6, legacy / fast, sink);
+	}
+}
+
+int main() {
+	constexpr size_t tokens = 50000;	// һ f0_seq 
+	constexpr int repeat = 40;
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> hz(80.0f, 800.0f);
+	std::uniform_int_distribution<int> num(0, 4);
+	const char* phonemes[] = { "SP", "AP", "a", "zh", "ang", "sh", "i" };
+
+	std::string floats, ints, strings;
+	for (size_t i = 0; i < tokens; ++i) {
+		if (i != 0) {
+			floats += ' ';
+			ints += ' ';
+			strings += ' ';
+		}
+		floats += std::to_string(hz(rng));
+		ints += std::to_string(num(rng));
+		strings += phonemes[num(rng)];
+	}
+
+	run<float>("float", floats, tokens, repeat);
+	run<int>("int", ints, tokens, repeat);
+	run<std::string>("string", strings, tokens, repeat);
+	return 0;
+}